@@ -0,0 +1,195 @@
+/**
+ * @file binio.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Formatos binários de problemas (.bpal) e de resultados (.bpath).
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "binio.h"
+#include "const.h"
+
+/**
+ * @brief Escreve a identificação de um ficheiro binário.
+ *
+ * @param f Ficheiro.
+ * @param magic PAL_MAGIC ou PATH_MAGIC.
+ */
+void bin_write_magic(FILE *f, const char *magic)
+{
+	fwrite(magic, 1, strlen(magic) + 1, f);
+}
+
+/**
+ * @brief Lê e verifica a identificação de um ficheiro binário.
+ *
+ * @param f Ficheiro, no início.
+ * @param magic PAL_MAGIC ou PATH_MAGIC.
+ * @return Verdadeiro se o ficheiro começar por magic.
+ */
+bool bin_check_magic(FILE *f, const char *magic)
+{
+	char buffer[16];
+	size_t len = strlen(magic) + 1;
+
+	return len <= sizeof(buffer) && fread(buffer, 1, len, f) == len
+		&& memcmp(buffer, magic, len) == 0;
+}
+
+/**
+ * @brief Lê uma palavra precedida do seu tamanho.
+ *
+ * @return 1 se leu, 0 no fim do ficheiro, -1 se estiver corrompido.
+ */
+static int read_word(FILE *f, char *word)
+{
+	int len;
+
+	if ((len = fgetc(f)) == EOF) {
+		return 0;
+	}
+	if (len >= MAX_WORD_SIZE || fread(word, 1, len, f) != (size_t) len) {
+		return -1;
+	}
+	word[len] = '\0';
+
+	return 1;
+}
+
+/**
+ * @brief Lê um problema de um ficheiro .bpal.
+ *
+ * @param f Ficheiro, depois da identificação.
+ * @param word1 Onde guardar a palavra de partida (MAX_WORD_SIZE bytes).
+ * @param word2 Onde guardar a palavra de chegada (MAX_WORD_SIZE bytes).
+ * @param max_perm Onde guardar o número de permutações.
+ * @return 1 se leu um problema, 0 no fim do ficheiro, -1 se estiver
+ *	corrompido (um problema incompleto ou palavras grandes de mais).
+ */
+int bin_read_problem(FILE *f, char *word1, char *word2, unsigned short *max_perm)
+{
+	int r;
+
+	if ((r = read_word(f, word1)) <= 0) {
+		return r;
+	}
+	if (read_word(f, word2) != 1 || fread(max_perm, sizeof(unsigned short), 1, f) != 1) {
+		return -1;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief Lê um problema de um .bpal já em memória.
+ *
+ * @param buf Início do problema.
+ * @param len Bytes disponíveis a partir de buf.
+ * @param word1 Onde guardar a palavra de partida (MAX_WORD_SIZE bytes).
+ * @param word2 Onde guardar a palavra de chegada (MAX_WORD_SIZE bytes).
+ * @param max_perm Onde guardar o número de permutações.
+ * @return Tamanho do problema em bytes, 0 se len for 0, ou -1 se estiver
+ *	corrompido (como em bin_read_problem()).
+ */
+long bin_scan_problem(const char *buf, long len, char *word1, char *word2,
+		unsigned short *max_perm)
+{
+	long pos = 0;
+	int i, n;
+	char *word;
+
+	if (len == 0) {
+		return 0;
+	}
+	for (i = 0; i < 2; i++) {
+		word = i == 0 ? word1 : word2;
+		if (pos >= len || (n = (unsigned char) buf[pos]) >= MAX_WORD_SIZE
+				|| pos + 1 + n > len) {
+			return -1;
+		}
+		memcpy(word, buf + pos + 1, n);
+		word[n] = '\0';
+		pos += 1 + n;
+	}
+	if (pos + (long) sizeof(unsigned short) > len) {
+		return -1;
+	}
+	memcpy(max_perm, buf + pos, sizeof(unsigned short));
+
+	return pos + sizeof(unsigned short);
+}
+
+/**
+ * @brief Escreve um problema num ficheiro .bpal.
+ *
+ * @param f Ficheiro.
+ * @param word1 Palavra de partida (menos de MAX_WORD_SIZE carateres).
+ * @param word2 Palavra de chegada (idem).
+ * @param max_perm Número de permutações.
+ */
+void bin_write_problem(FILE *f, const char *word1, const char *word2,
+		unsigned short max_perm)
+{
+	fputc((int) strlen(word1), f);
+	fputs(word1, f);
+	fputc((int) strlen(word2), f);
+	fputs(word2, f);
+	fwrite(&max_perm, sizeof(unsigned short), 1, f);
+}
+
+/**
+ * @brief Acrescenta a um buffer o início de um resultado binário; seguem-se
+ *	n chamadas a bin_put_vertex().
+ *
+ * @param b Buffer.
+ * @param cost Custo ou código de erro.
+ * @param n Número de vértices do caminho.
+ */
+void bin_put_result(OutBuf *b, int cost, int n)
+{
+	unsigned short count = (unsigned short) n;
+
+	ob_bytes(b, (char *) &cost, sizeof(int));
+	ob_bytes(b, (char *) &count, sizeof(unsigned short));
+}
+
+/**
+ * @brief Acrescenta a um buffer um vértice de um resultado binário.
+ *
+ * @param b Buffer.
+ * @param v Índice do vértice.
+ */
+void bin_put_vertex(OutBuf *b, int v)
+{
+	unsigned short index = (unsigned short) v;
+
+	ob_bytes(b, (char *) &index, sizeof(unsigned short));
+}
+
+/**
+ * @brief Lê um resultado de um ficheiro .bpath.
+ *
+ * @param f Ficheiro, depois da identificação.
+ * @param cost Onde guardar o custo.
+ * @param path Onde guardar os vértices do caminho.
+ * @param max Capacidade de path.
+ * @return Número de vértices, -1 no fim do ficheiro, ou -2 se estiver
+ *	corrompido (ou o caminho não couber em path).
+ */
+int bin_read_result(FILE *f, int *cost, unsigned short *path, int max)
+{
+	unsigned short n;
+
+	if (fread(cost, sizeof(int), 1, f) != 1) {
+		return -1;
+	}
+	if (fread(&n, sizeof(unsigned short), 1, f) != 1 || n > max
+			|| fread(path, sizeof(unsigned short), n, f) != n) {
+		return -2;
+	}
+
+	return n;
+}
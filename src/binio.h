@@ -0,0 +1,48 @@
+/**
+ * @file binio.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Formatos binários de problemas (.bpal) e de resultados (.bpath).
+ * @details
+ *	Os dois ficheiros começam pela sua identificação (PAL_MAGIC ou
+ *	PATH_MAGIC, com o '\0'); os inteiros estão na ordem de bytes da
+ *	máquina, como nos ficheiros de --alt-file e --result-cache.
+ *
+ *	Problema: tamanho de word1 (1 byte), word1, tamanho de word2 (1 byte),
+ *	word2, número de permutações (unsigned short).
+ *
+ *	Resultado, um por problema e pela mesma ordem: custo (int, ou código
+ *	de const.h), número de vértices n (unsigned short) e os n índices dos
+ *	vértices do caminho, da origem ao destino (unsigned short). O índice
+ *	de uma palavra é a sua posição entre as palavras do mesmo tamanho, pela
+ *	ordem do dicionário. n é 0 quando não há caminho e nos problemas
+ *	triviais (palavras a menos de duas letras), que são respondidos sem
+ *	consultar o dicionário; as palavras estão então no problema.
+ */
+#ifndef _BINIO_H
+#define _BINIO_H
+
+#include <stdio.h>
+
+#include "bool.h"
+#include "outbuf.h"
+
+#define PAL_MAGIC "WMPB1"
+#define PATH_MAGIC "WMRB1"
+#define BIN_PAL_EXT ".bpal"
+#define BIN_PATH_EXT ".bpath"
+
+void bin_write_magic(FILE *f, const char *magic);
+bool bin_check_magic(FILE *f, const char *magic);
+int bin_read_problem(FILE *f, char *word1, char *word2, unsigned short *max_perm);
+long bin_scan_problem(const char *buf, long len, char *word1, char *word2,
+		unsigned short *max_perm);
+void bin_write_problem(FILE *f, const char *word1, const char *word2,
+		unsigned short max_perm);
+void bin_put_result(OutBuf *b, int cost, int n);
+void bin_put_vertex(OutBuf *b, int v);
+int bin_read_result(FILE *f, int *cost, unsigned short *path, int max);
+
+#endif
@@ -0,0 +1,164 @@
+/**
+ * @file bucket.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Fila de baldes (Dial) de vértices com chaves inteiras monótonas.
+ * @details
+ *	Há um balde por chave, num vetor circular com pelo menos span + 1
+ *	baldes: como as chaves na fila estão entre cur e cur + span, nunca
+ *	duas chaves diferentes partilham um balde. Retirar avança cur até ao
+ *	primeiro balde não vazio; inserir é só acrescentar ao balde da chave.
+ *
+ *	Com pesos de arestas pequenos (aqui, no máximo o quadrado do número de
+ *	permutações), o vetor é pequeno e cur avança pouco de cada vez.
+ */
+#include <stdlib.h>
+
+#include "bucket.h"
+#include "utils.h"
+
+/**
+ * @brief Balde: pilha de vértices com a mesma chave.
+ */
+typedef struct _Bucket {
+	int *vertex;
+	int count;
+	int max;
+} Bucket;
+
+/**
+ * @brief Fila.
+ * @details bucket: vetor circular de num baldes (uma potência de 2); a
+ *	chave key está no balde key & (num - 1)
+ *	cur: menor chave que pode estar na fila, -1 antes da primeira inserção
+ *	count: número de elementos em todos os baldes
+ */
+struct _BucketQueue {
+	Bucket *bucket;
+	int num;
+	int cur;
+	int count;
+};
+
+/**
+ * @brief Cria uma fila vazia, sem baldes (ver bq_clear()).
+ *
+ * @return Fila.
+ */
+BucketQueue *bq_init(void)
+{
+	BucketQueue *q = (BucketQueue *) emalloc(sizeof(BucketQueue));
+
+	q->bucket = NULL;
+	q->num = 0;
+	q->cur = -1;
+	q->count = 0;
+
+	return q;
+}
+
+/**
+ * @brief Liberta a fila.
+ *
+ * @param q Fila.
+ */
+void bq_free(BucketQueue *q)
+{
+	int i;
+
+	for (i = 0; i < q->num; i++) {
+		free(q->bucket[i].vertex);
+	}
+	free(q->bucket);
+	free(q);
+}
+
+/**
+ * @brief Esvazia a fila, garantindo baldes para chaves até span acima da
+ *	menor.
+ *
+ * @param q Fila.
+ * @param span Maior diferença entre chaves na fila ao mesmo tempo.
+ */
+void bq_clear(BucketQueue *q, int span)
+{
+	int i, num;
+
+	if (span >= q->num) {
+		for (num = 1; num <= span; num *= 2)
+			;
+		for (i = 0; i < q->num; i++) {
+			free(q->bucket[i].vertex);
+		}
+		free(q->bucket);
+		q->bucket = (Bucket *) emalloc(num * sizeof(Bucket));
+		for (i = 0; i < num; i++) {
+			q->bucket[i].vertex = NULL;
+			q->bucket[i].max = 0;
+		}
+		q->num = num;
+	}
+	for (i = 0; i < q->num; i++) {
+		q->bucket[i].count = 0;
+	}
+	q->cur = -1;
+	q->count = 0;
+}
+
+/**
+ * @brief Verifica se a fila está vazia.
+ *
+ * @param q Fila.
+ * @return Verdadeiro se estiver vazia.
+ */
+bool bq_empty(BucketQueue *q)
+{
+	return q->count == 0;
+}
+
+/**
+ * @brief Insere um vértice, que pode já estar na fila.
+ *
+ * @param q Fila.
+ * @param v Vértice.
+ * @param key Chave, entre a menor chave na fila (ou a última retirada) e
+ *	essa mais span.
+ */
+void bq_push(BucketQueue *q, int v, int key)
+{
+	Bucket *b;
+
+	/* A fila pode esvaziar-se a meio de uma pesquisa: cur só é
+	 * escolhido na primeira inserção depois de bq_clear(). */
+	if (q->cur < 0) {
+		q->cur = key;
+	}
+	q->count++;
+	b = &q->bucket[key & (q->num - 1)];
+	if (b->count == b->max) {
+		b->max = b->max ? 2 * b->max : 16;
+		b->vertex = (int *) erealloc(b->vertex, b->max * sizeof(int));
+	}
+	b->vertex[b->count++] = v;
+}
+
+/**
+ * @brief Retira um vértice de menor chave; a fila não pode estar vazia.
+ * @details Entre chaves iguais, sai primeiro o último inserido.
+ *
+ * @param q Fila.
+ * @return Vértice.
+ */
+int bq_pop(BucketQueue *q)
+{
+	Bucket *b;
+	int mask = q->num - 1;
+
+	while ((b = &q->bucket[q->cur & mask])->count == 0) {
+		q->cur++;
+	}
+	q->count--;
+	return b->vertex[--b->count];
+}
@@ -0,0 +1,27 @@
+/**
+ * @file bucket.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Fila de baldes (Dial) de vértices com chaves inteiras monótonas.
+ * @details
+ *	Fila prioritária em que cada chave inserida está entre a menor chave
+ *	na fila e essa mais span, como em Dijkstra com arestas de peso até
+ *	span. Aceita cópias do mesmo vértice, como LHeap.
+ */
+#ifndef _BUCKET_H
+#define _BUCKET_H
+
+#include "bool.h"
+
+typedef struct _BucketQueue BucketQueue;
+
+BucketQueue *bq_init(void);
+void bq_free(BucketQueue *q);
+void bq_clear(BucketQueue *q, int span);
+bool bq_empty(BucketQueue *q);
+void bq_push(BucketQueue *q, int v, int key);
+int bq_pop(BucketQueue *q);
+
+#endif
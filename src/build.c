@@ -0,0 +1,342 @@
+/**
+ * @file build.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Construção das arestas de vários grafos em paralelo.
+ * @details
+ *	O custo de g_make_edges() é comparar todos os pares de vértices. Aqui
+ *	as linhas de cada grafo (vértice i, comparado com todos os j < i) são
+ *	repartidas em tarefas com aproximadamente o mesmo número de pares, que
+ *	vários fios de execução comparam ao mesmo tempo.
+ *
+ *	As tarefas são distribuídas pelas filas dos fios, dos grafos maiores
+ *	para os menores. Cada fio tira tarefas do início da sua fila (as
+ *	maiores); quando esta se esgota, rouba do fim da fila de outro fio (as
+ *	menores), para que todos acabem quase ao mesmo tempo.
+ *
+ *	As tarefas só guardam as arestas encontradas. Quando todas as tarefas
+ *	de um grafo acabam, o fio que acabou a última insere as arestas no
+ *	grafo pela ordem de g_make_edges(), pelo que as listas de adjacências
+ *	ficam iguais às da construção em série. Grafos diferentes são inseridos
+ *	por fios diferentes ao mesmo tempo.
+ */
+/* Fios de execução são POSIX, não fazem parte de C89. */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "build.h"
+#include "utils.h"
+
+/* Número mínimo de pares de vértices de uma tarefa: abaixo disto, o custo
+ * de a gerir não compensa. */
+#define MIN_TASK_PAIRS (1L << 20)
+/* Tarefas por fio, para que os roubos equilibrem a carga. */
+#define TASKS_PER_THREAD 8
+
+/**
+ * @brief Linhas [first, end) de um grafo.
+ * @details job: grafo (índice em jobs)
+ *	edges: arestas encontradas, em triplos (i, j, peso), por ordem
+ *	count, max: triplos guardados e espaço alocado
+ */
+typedef struct _Task {
+	int job;
+	unsigned short first, end;
+	unsigned short *edges;
+	unsigned long count, max;
+} Task;
+
+/**
+ * @brief Grafo a construir.
+ * @details g: grafo, sem arestas e com o peso máximo ainda por elevar
+ *	items: items dos vértices, por índice
+ *	first, num: as suas tarefas em tasks, por ordem das linhas
+ *	remaining: tarefas por acabar (protegido por done_lock)
+ *	seconds: tempo desde o início até as arestas estarem inseridas
+ */
+typedef struct _Job {
+	Graph *g;
+	Item *items;
+	int first, num;
+	int remaining;
+	double seconds;
+} Job;
+
+/**
+ * @brief Fila de tarefas de um fio: índices em tasks, de head a tail.
+ */
+typedef struct _Deque {
+	pthread_mutex_t lock;
+	int *tasks;
+	int head, tail;
+} Deque;
+
+/* Estado da construção, partilhado pelos fios. */
+static Task *tasks = NULL;
+static Job *jobs = NULL;
+static Deque *deques = NULL;
+static int num_threads = 0;
+static pthread_mutex_t done_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned short (*bd_weight)(Item i1, Item i2, unsigned short max) = NULL;
+static double start = 0;
+
+/**
+ * @brief Guarda uma aresta encontrada por uma tarefa.
+ */
+static void bd_push(Task *t, unsigned short i, unsigned short j, unsigned short weight)
+{
+	if (t->count == t->max) {
+		t->max = t->max ? 2 * t->max : 1024;
+		t->edges = (unsigned short *) erealloc(t->edges,
+				3 * t->max * sizeof(unsigned short));
+	}
+	t->edges[3*t->count] = i;
+	t->edges[3*t->count + 1] = j;
+	t->edges[3*t->count + 2] = weight;
+	t->count++;
+}
+
+/**
+ * @brief Compara os pares das linhas de uma tarefa, como g_make_edges().
+ */
+static void bd_run(Task *t)
+{
+	Job *job = &jobs[t->job];
+	unsigned short max = g_get_max_weight(job->g);
+	unsigned short i, j, weight;
+
+	for (i = t->first; i < t->end; i++) {
+		for (j = 0; j < i; j++) {
+			weight = bd_weight(job->items[i], job->items[j], max);
+			if (weight <= max) {
+				/* Agora o peso entra quadraticamente. */
+				bd_push(t, i, j, weight*weight);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Insere no grafo as arestas de todas as suas tarefas, por ordem.
+ */
+static void bd_merge(Job *job)
+{
+	Task *t;
+	unsigned long k;
+	int n;
+
+	for (n = 0; n < job->num; n++) {
+		t = &tasks[job->first + n];
+		for (k = 0; k < t->count; k++) {
+			e_add(job->g, t->edges[3*k], t->edges[3*k + 1], t->edges[3*k + 2]);
+		}
+		free(t->edges);
+		t->edges = NULL;
+	}
+	g_set_max_weight(job->g, g_get_max_weight(job->g) * g_get_max_weight(job->g));
+	job->seconds = mono_time() - start;
+}
+
+/**
+ * @brief Tira uma tarefa da fila do fio, ou rouba uma de outro fio.
+ *
+ * @param me Índice do fio.
+ * @return Índice da tarefa, ou -1 se já não houver nenhuma.
+ */
+static int bd_take(int me)
+{
+	Deque *d;
+	int k, t = -1;
+
+	for (k = 0; k < num_threads && t == -1; k++) {
+		d = &deques[(me + k) % num_threads];
+		pthread_mutex_lock(&d->lock);
+		if (d->head < d->tail) {
+			/* Da própria fila as maiores, das outras as menores. */
+			t = k == 0 ? d->tasks[d->head++] : d->tasks[--d->tail];
+		}
+		pthread_mutex_unlock(&d->lock);
+	}
+
+	return t;
+}
+
+/**
+ * @brief Ciclo de um fio: fazer tarefas até não haver mais.
+ *
+ * @param arg Índice do fio (int *).
+ * @return NULL.
+ */
+static void *bd_thread(void *arg)
+{
+	int me = *((int *) arg);
+	int t;
+	bool last;
+
+	while ((t = bd_take(me)) != -1) {
+		bd_run(&tasks[t]);
+
+		pthread_mutex_lock(&done_lock);
+		last = --jobs[tasks[t].job].remaining == 0;
+		pthread_mutex_unlock(&done_lock);
+
+		if (last) {
+			bd_merge(&jobs[tasks[t].job]);
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Comparador para qsort(): grafos com mais vértices primeiro.
+ */
+static int bd_cmp(const void *a, const void *b)
+{
+	const Job *p = (const Job *) a, *q = (const Job *) b;
+
+	return (int) g_get_size(q->g) - (int) g_get_size(p->g);
+}
+
+/**
+ * @brief Constrói as arestas de vários grafos com vários fios de execução.
+ * @details O resultado é o mesmo de chamar g_make_edges() para cada grafo.
+ *	Com um só fio, é isso mesmo que é feito. Só pode haver uma construção
+ *	de cada vez (nos modos com vários fios, é feita com acesso exclusivo,
+ *	ver lock.c).
+ *
+ * @param graphs Grafos, com os vértices e sem arestas, cada um com o peso
+ *	máximo de g_init() ou g_clear_edges().
+ * @param count Número de grafos.
+ * @param threads Número de fios de execução.
+ * @param calc_weight Função que calcula o peso entre dois items.
+ * @param seconds Onde guardar, para cada grafo, o tempo desde o início até
+ *	as suas arestas estarem construídas.
+ */
+void bd_make_edges(Graph **graphs, int count, int threads,
+		unsigned short (*calc_weight)(Item i1, Item i2, unsigned short max),
+		double *seconds)
+{
+	pthread_t *thread;
+	int *ids;
+	int i, k, n, num_tasks;
+	unsigned short v, size, first;
+	double total = 0, target, pairs;
+
+	start = mono_time();
+	if (threads <= 1) {
+		for (i = 0; i < count; i++) {
+			g_make_edges(graphs[i], calc_weight);
+			seconds[i] = mono_time() - start;
+		}
+		return;
+	}
+
+	/* Grafos dos maiores para os menores. */
+	jobs = (Job *) emalloc((count > 0 ? count : 1) * sizeof(Job));
+	for (i = 0; i < count; i++) {
+		jobs[i].g = graphs[i];
+		size = g_get_size(graphs[i]);
+		total += (double) size * (size - 1) / 2;
+	}
+	qsort(jobs, count, sizeof(Job), bd_cmp);
+
+	/* Repartir as linhas de cada grafo em tarefas de pelo menos target
+	 * pares; a linha i tem i pares. */
+	target = total / (threads * TASKS_PER_THREAD);
+	if (target < MIN_TASK_PAIRS) {
+		target = MIN_TASK_PAIRS;
+	}
+	tasks = NULL;
+	num_tasks = 0;
+	n = 0;
+	for (i = 0; i < count; i++) {
+		size = g_get_size(jobs[i].g);
+		jobs[i].items = (Item *) emalloc((size > 0 ? size : 1) * sizeof(Item));
+		for (v = 0; v < size; v++) {
+			jobs[i].items[v] = v_get_item(g_get_vertex(jobs[i].g, v));
+		}
+		jobs[i].first = num_tasks;
+		first = 0;
+		pairs = 0;
+		for (v = 0; v < size; v++) {
+			pairs += v;
+			if (pairs >= target || v + 1 == size) {
+				if (num_tasks == n) {
+					n = n ? 2 * n : 64;
+					tasks = (Task *) erealloc(tasks, n * sizeof(Task));
+				}
+				tasks[num_tasks].job = i;
+				tasks[num_tasks].first = first;
+				tasks[num_tasks].end = v + 1;
+				tasks[num_tasks].edges = NULL;
+				tasks[num_tasks].count = tasks[num_tasks].max = 0;
+				num_tasks++;
+				first = v + 1;
+				pairs = 0;
+			}
+		}
+		jobs[i].num = num_tasks - jobs[i].first;
+		jobs[i].remaining = jobs[i].num;
+		/* Grafo sem vértices: não há tarefas que o acabem. */
+		if (jobs[i].num == 0) {
+			bd_merge(&jobs[i]);
+		}
+	}
+
+	/* Distribuir as tarefas pelas filas, por ordem, à vez. */
+	num_threads = threads;
+	deques = (Deque *) emalloc(threads * sizeof(Deque));
+	for (k = 0; k < threads; k++) {
+		pthread_mutex_init(&deques[k].lock, NULL);
+		deques[k].tasks = (int *) emalloc((num_tasks / threads + 1) * sizeof(int));
+		deques[k].head = deques[k].tail = 0;
+	}
+	for (i = 0; i < num_tasks; i++) {
+		deques[i % threads].tasks[deques[i % threads].tail++] = i;
+	}
+
+	bd_weight = calc_weight;
+	thread = (pthread_t *) emalloc(threads * sizeof(pthread_t));
+	ids = (int *) emalloc(threads * sizeof(int));
+	for (k = 0; k < threads; k++) {
+		ids[k] = k;
+		if (pthread_create(&thread[k], NULL, bd_thread, &ids[k]) != 0) {
+			fprintf(stderr, "Erro: impossível criar fio de construção.\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	for (k = 0; k < threads; k++) {
+		pthread_join(thread[k], NULL);
+	}
+
+	/* Os tempos pela ordem de graphs. */
+	for (i = 0; i < count; i++) {
+		for (k = 0; k < count; k++) {
+			if (jobs[k].g == graphs[i]) {
+				seconds[i] = jobs[k].seconds;
+			}
+		}
+	}
+
+	for (k = 0; k < threads; k++) {
+		pthread_mutex_destroy(&deques[k].lock);
+		free(deques[k].tasks);
+	}
+	for (i = 0; i < count; i++) {
+		free(jobs[i].items);
+	}
+	free(deques);
+	free(thread);
+	free(ids);
+	free(tasks);
+	free(jobs);
+	tasks = NULL;
+	jobs = NULL;
+	deques = NULL;
+}
@@ -0,0 +1,18 @@
+/**
+ * @file build.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Construção das arestas de vários grafos em paralelo.
+ */
+#ifndef _BUILD_H
+#define _BUILD_H
+
+#include "graph.h"
+
+void bd_make_edges(Graph **graphs, int count, int threads,
+		unsigned short (*calc_weight)(Item i1, Item i2, unsigned short max),
+		double *seconds);
+
+#endif
@@ -0,0 +1,848 @@
+/**
+ * @file ch.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Hierarquias de contração (contraction hierarchies).
+ * @details
+ *	Pré-processamento: os vértices do grafo são contraídos um a um, por
+ *	ordem de diferença de arestas; ao contrair v, cada par de vizinhos u, w
+ *	cujo caminho mais curto passa por v (não há caminho testemunha) recebe
+ *	um atalho u-w. No fim, cada vértice guarda apenas as arestas para
+ *	vértices mais importantes (contraídos depois).
+ *
+ *	Consulta: pesquisa de Dijkstra bidirecional apenas por arestas
+ *	ascendentes; os atalhos do caminho encontrado são depois expandidos
+ *	nas palavras intermédias.
+ *
+ *	Como os atalhos dependem das arestas admissíveis, cada hierarquia
+ *	corresponde a um único peso máximo de arestas.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "ch.h"
+#include "graph.h"
+#include "heap.h"
+#include "dijkstra.h"
+#include "packed.h"
+#include "utils.h"
+
+/* Número máximo de vértices fixados por cada pesquisa de testemunhas.
+ * Se o limite for atingido acrescenta-se o atalho, o que nunca torna a
+ * hierarquia incorreta, apenas maior. */
+#define WITNESS_LIMIT 100
+
+/* Vértices com mais vizinhos que CORE_DEGREE não são contraídos: a
+ * contração de vértices muito ligados (palavras longas com várias
+ * permutações) gera atalhos em número quadrático. Quando só restam estes
+ * vértices, a contração pára e eles formam o núcleo da hierarquia, onde a
+ * consulta é uma pesquisa bidirecional normal. */
+#define CORE_DEGREE 16
+#define CORE_PRIO MAX_WT
+
+/**
+ * @brief Aresta da hierarquia.
+ * @details to: índice do vértice de destino
+ *	weight: peso da aresta
+ *	middle: vértice contraído que o atalho substitui, -1 se for uma aresta
+ *	do grafo original
+ */
+typedef struct _ChEdge {
+	int to;
+	int weight;
+	int middle;
+} ChEdge;
+
+/**
+ * @brief Hierarquia de contração de um grafo para um peso máximo de arestas.
+ * @details max_weight: peso máximo das arestas do grafo consideradas
+ *	size: número de vértices
+ *	rank: ordem de contração de cada vértice (os vértices do núcleo têm as
+ *	últimas ordens)
+ *	first, up: arestas ascendentes do vértice v em up[first[v]..first[v+1]-1];
+ *	num vértice do núcleo, são todas as suas arestas para o núcleo
+ *	next: próxima hierarquia do mesmo grafo
+ *
+ *	Depois de construída, a hierarquia só é lida: as consultas escrevem
+ *	apenas nas suas tabelas de trabalho (ChScratch).
+ */
+struct _Hierarchy {
+	unsigned short max_weight;
+	int size;
+	int *rank;
+	int *first;
+	ChEdge *up;
+	struct _Hierarchy *next;
+};
+
+/**
+ * @brief Tabelas de trabalho das consultas.
+ * @details size: número de vértices para que as tabelas estão alocadas
+ *	dist, parent, pmid: distâncias, antecessores e vértice do meio da aresta
+ *	do antecessor, da pesquisa ascendente a partir da origem ([0]) e do
+ *	destino ([1])
+ *	touched, ntouched: vértices alcançados nas pesquisas, para reinicializar
+ *	items, heap: items (com a distância como prioridade) e filas das
+ *	pesquisas em cada direção
+ */
+struct _ChScratch {
+	int size;
+	int *dist[2];
+	int *parent[2];
+	int *pmid[2];
+	int *touched;
+	int ntouched;
+	SpItem *items[2];
+	Heap *heap[2];
+};
+
+/**
+ * @brief Estado da construção de uma hierarquia.
+ * @details adj, deg, cap: listas de adjacências dinâmicas dos vértices
+ *	ainda não contraídos (com os atalhos já inseridos)
+ *	deleted: número de vizinhos de cada vértice já contraídos
+ *	wdist, touched, ntouched: distâncias da pesquisa de testemunhas
+ *	target, tdist: marca dos vértices que a pesquisa de testemunhas tem de
+ *	fixar (igual ao vértice de partida da pesquisa) e comprimento do atalho
+ *	que uma testemunha tem de igualar
+ *	pend, npend, cpend: atalhos pendentes da última simulação de contração
+ *	items, heap: items (com wdist como prioridade) e fila da pesquisa de
+ *	testemunhas
+ */
+typedef struct _ChBuild {
+	int size;
+	ChEdge **adj;
+	int *deg;
+	int *cap;
+	int *deleted;
+	int *wdist;
+	int *touched;
+	int ntouched;
+	int *target;
+	int *tdist;
+	ChEdge *pend;
+	int npend;
+	int cpend;
+	SpItem *items;
+	Heap *heap;
+} ChBuild;
+
+/**
+ * @brief Acrescenta uma aresta à lista de adjacências dinâmica de u.
+ *
+ * @param b Estado da construção.
+ * @param u Vértice de partida.
+ * @param w Vértice de destino.
+ * @param weight Peso da aresta.
+ * @param middle Vértice contraído que a aresta substitui, ou -1.
+ */
+static void ch_append(ChBuild *b, int u, int w, int weight, int middle)
+{
+	if (b->deg[u] == b->cap[u]) {
+		b->cap[u] = b->cap[u] ? 2 * b->cap[u] : 4;
+		b->adj[u] = (ChEdge *) erealloc(b->adj[u], b->cap[u] * sizeof(ChEdge));
+	}
+	b->adj[u][b->deg[u]].to = w;
+	b->adj[u][b->deg[u]].weight = weight;
+	b->adj[u][b->deg[u]].middle = middle;
+	b->deg[u]++;
+}
+
+/**
+ * @brief Insere ou encurta a aresta u-w na lista de adjacências de u.
+ *
+ * @param b Estado da construção.
+ * @param u Vértice de partida.
+ * @param w Vértice de destino.
+ * @param weight Peso do atalho.
+ * @param middle Vértice contraído que o atalho substitui.
+ */
+static void ch_shortcut(ChBuild *b, int u, int w, int weight, int middle)
+{
+	int i;
+
+	for (i = 0; i < b->deg[u]; i++) {
+		if (b->adj[u][i].to == w) {
+			if (weight < b->adj[u][i].weight) {
+				b->adj[u][i].weight = weight;
+				b->adj[u][i].middle = middle;
+			}
+			return;
+		}
+	}
+	ch_append(b, u, w, weight, middle);
+}
+
+/**
+ * @brief Pesquisa de testemunhas: Dijkstra limitado a partir de u, sem
+ *	passar por v.
+ * @details Se as arestas diretas de u já forem testemunhas de todos os
+ *	alvos, não é preciso pesquisar. Senão, a pesquisa termina quando foram
+ *	fixados todos os vértices alvo ou WITNESS_LIMIT vértices, e só segue
+ *	caminhos de comprimento até limit. As distâncias ficam em b->wdist até
+ *	ch_reset().
+ *
+ * @param b Estado da construção.
+ * @param u Vértice de partida.
+ * @param v Vértice a contrair (ignorado).
+ * @param limit Distância máxima que interessa.
+ * @param targets Número de vértices alvo (marcados com u em b->target,
+ *	com o comprimento do atalho em b->tdist).
+ */
+static void ch_witness(ChBuild *b, int u, int v, int limit, int targets)
+{
+	int x, y, i, nd;
+	int settled = 0, direct = 0;
+	bool in_heap;
+
+	b->wdist[u] = 0;
+	b->touched[b->ntouched++] = u;
+	for (i = 0; i < b->deg[u]; i++) {
+		y = b->adj[u][i].to;
+		if (b->target[y] == u && b->adj[u][i].weight <= b->tdist[y]) {
+			direct++;
+		}
+	}
+	if (direct == targets) {
+		/* Basta marcar os alvos com as arestas diretas. */
+		for (i = 0; i < b->deg[u]; i++) {
+			y = b->adj[u][i].to;
+			if (b->target[y] == u) {
+				b->wdist[y] = b->adj[u][i].weight;
+				b->touched[b->ntouched++] = y;
+			}
+		}
+		return;
+	}
+
+	b->items[u].pri = 0;
+	h_insert(b->heap, &(b->items[u]), d_less_pri, d_hash);
+
+	while (!h_empty(b->heap)) {
+		x = ((SpItem *) h_del_max_pri(b->heap, d_less_pri, d_hash))->index;
+		if (++settled > WITNESS_LIMIT) break;
+		if (b->target[x] == u && --targets == 0) break;
+		/* Não atravessar vértices do núcleo: as suas listas são longas e
+		 * raramente levam a uma testemunha que um vértice menos ligado não
+		 * dê. Falhar uma testemunha só acrescenta um atalho. */
+		if (b->deg[x] > CORE_DEGREE && x != u) continue;
+
+		for (i = 0; i < b->deg[x]; i++) {
+			y = b->adj[x][i].to;
+			if (y == v) continue;
+			nd = b->wdist[x] + b->adj[x][i].weight;
+			/* Caminhos mais longos que limit nunca são testemunhas. */
+			if (nd > limit) continue;
+			if (nd < b->wdist[y]) {
+				in_heap = (b->wdist[y] != MAX_WT);
+				if (!in_heap) {
+					b->touched[b->ntouched++] = y;
+				}
+				b->wdist[y] = nd;
+				b->items[y].pri = nd;
+				if (in_heap) {
+					h_inc_pri(b->heap, &(b->items[y]), d_less_pri, d_hash);
+				}
+				else {
+					h_insert(b->heap, &(b->items[y]), d_less_pri, d_hash);
+				}
+			}
+		}
+	}
+
+	/* Esvaziar a fila para a próxima pesquisa. */
+	h_clear(b->heap);
+}
+
+/**
+ * @brief Repõe as distâncias alcançadas pela última pesquisa de testemunhas.
+ *
+ * @param b Estado da construção.
+ */
+static void ch_reset(ChBuild *b)
+{
+	int i;
+
+	for (i = 0; i < b->ntouched; i++) {
+		b->wdist[b->touched[i]] = MAX_WT;
+	}
+	b->ntouched = 0;
+}
+
+/**
+ * @brief Encontra os atalhos necessários para contrair um vértice.
+ * @details Para cada par de vizinhos u, w de v, se não houver testemunha
+ *	(caminho u-w sem v de comprimento não superior a d(u,v) + d(v,w)), é
+ *	necessário um atalho. Os atalhos ficam pendentes em b->pend, para
+ *	ch_apply() os inserir se v for de facto contraído.
+ *
+ * @param b Estado da construção.
+ * @param v Vértice a contrair.
+ * @return Número de atalhos necessários.
+ */
+static int ch_contract(ChBuild *b, int v)
+{
+	ChEdge *e = b->adj[v];
+	int n = b->deg[v];
+	int i, j, sc;
+	int max_vw; /* Maior peso das arestas de v para os alvos. */
+
+	b->npend = 0;
+
+	/* Basta considerar cada par uma vez: a partir de e[i].to, os alvos
+	 * são os vizinhos seguintes e[j].to, j > i. */
+	for (i = 0; i < n - 1; i++) {
+		max_vw = 0;
+		for (j = i + 1; j < n; j++) {
+			b->target[e[j].to] = e[i].to;
+			b->tdist[e[j].to] = e[i].weight + e[j].weight;
+			if (e[j].weight > max_vw) {
+				max_vw = e[j].weight;
+			}
+		}
+
+		ch_witness(b, e[i].to, v, e[i].weight + max_vw, n - 1 - i);
+		for (j = i + 1; j < n; j++) {
+			sc = e[i].weight + e[j].weight;
+			if (b->wdist[e[j].to] <= sc) continue;
+
+			if (b->npend == b->cpend) {
+				b->cpend = b->cpend ? 2 * b->cpend : 64;
+				b->pend = (ChEdge *) erealloc(b->pend, b->cpend * sizeof(ChEdge));
+			}
+			/* to e middle guardam os extremos do atalho. */
+			b->pend[b->npend].to = e[i].to;
+			b->pend[b->npend].middle = e[j].to;
+			b->pend[b->npend].weight = sc;
+			b->npend++;
+		}
+		ch_reset(b);
+	}
+
+	return b->npend;
+}
+
+/**
+ * @brief Contrai um vértice, inserindo os atalhos encontrados pela última
+ *	chamada a ch_contract() para esse vértice.
+ *
+ * @param b Estado da construção.
+ * @param v Vértice a contrair.
+ */
+static void ch_apply(ChBuild *b, int v)
+{
+	int i;
+
+	for (i = 0; i < b->npend; i++) {
+		ch_shortcut(b, b->pend[i].to, b->pend[i].middle, b->pend[i].weight, v);
+		ch_shortcut(b, b->pend[i].middle, b->pend[i].to, b->pend[i].weight, v);
+	}
+}
+
+/**
+ * @brief Prioridade de contração: diferença de arestas mais número de
+ *	vizinhos já contraídos (para uniformizar a contração pelo grafo).
+ *
+ * @param b Estado da construção.
+ * @param v Vértice.
+ * @return Prioridade (menor contrai primeiro), CORE_PRIO se v tiver
+ *	demasiados vizinhos para ser contraído.
+ */
+static int ch_priority(ChBuild *b, int v)
+{
+	if (b->deg[v] > CORE_DEGREE) {
+		return CORE_PRIO;
+	}
+	return ch_contract(b, v) - b->deg[v] + b->deleted[v];
+}
+
+/**
+ * @brief Retira v das listas de adjacências dos seus vizinhos.
+ * @details A lista de v fica intacta: tem exatamente as arestas
+ *	ascendentes de v na hierarquia.
+ *
+ * @param b Estado da construção.
+ * @param v Vértice contraído.
+ */
+static void ch_remove(ChBuild *b, int v)
+{
+	int i, j, u;
+
+	for (i = 0; i < b->deg[v]; i++) {
+		u = b->adj[v][i].to;
+		for (j = 0; j < b->deg[u]; j++) {
+			if (b->adj[u][j].to == v) {
+				b->adj[u][j] = b->adj[u][--b->deg[u]];
+				break;
+			}
+		}
+		b->deleted[u]++;
+	}
+}
+
+/**
+ * @brief Constrói a hierarquia de contração de um grafo.
+ *
+ * @param g Ponteiro para grafo.
+ * @param max_weight Peso máximo de arestas a considerar.
+ * @return Hierarquia.
+ */
+Hierarchy *ch_build(Graph *g, unsigned short max_weight)
+{
+	Hierarchy *ch;
+	ChBuild b;
+	Heap *order; /* Fila de contração. */
+	SpItem *prio; /* Items da fila de contração, com as prioridades. */
+	int size = g_get_size(g);
+	int v, i, p, r;
+	unsigned short index, weight;
+	PkIter l;
+
+	b.size = size;
+	b.adj = (ChEdge **) ecalloc(size, sizeof(ChEdge *));
+	b.deg = (int *) ecalloc(size, sizeof(int));
+	b.cap = (int *) ecalloc(size, sizeof(int));
+	b.deleted = (int *) ecalloc(size, sizeof(int));
+	b.wdist = (int *) emalloc(size * sizeof(int));
+	b.touched = (int *) emalloc(size * sizeof(int));
+	b.ntouched = 0;
+	b.target = (int *) emalloc(size * sizeof(int));
+	b.tdist = (int *) emalloc(size * sizeof(int));
+	b.pend = NULL;
+	b.npend = 0;
+	b.cpend = 0;
+	b.items = (SpItem *) emalloc(size * sizeof(SpItem));
+	b.heap = h_init(size);
+	prio = (SpItem *) emalloc(size * sizeof(SpItem));
+
+	for (v = 0; v < size; v++) {
+		b.wdist[v] = MAX_WT;
+		b.target[v] = -1;
+		b.items[v].index = v;
+		prio[v].index = v;
+		for (pk_begin(g, v, &l); pk_next(&l, &index, &weight); ) {
+			if (weight <= max_weight) {
+				ch_append(&b, v, index, weight, -1);
+			}
+		}
+	}
+
+	ch = (Hierarchy *) emalloc(sizeof(Hierarchy));
+	ch->max_weight = max_weight;
+	ch->size = size;
+	ch->rank = (int *) emalloc(size * sizeof(int));
+	ch->next = NULL;
+	for (v = 0; v < size; v++) {
+		ch->rank[v] = -1;
+	}
+
+	/* Ordenar a contração pela diferença de arestas, com atualização
+	 * preguiçosa: ao sair da fila, a prioridade é recalculada e, se
+	 * piorou, o vértice volta à fila. Os vértices entram na fila pela
+	 * ordem original (ver g_permute()), que decide os empates. */
+	order = h_init(size);
+	for (i = 0; i < size; i++) {
+		v = g_get_index(g, i);
+		prio[v].pri = ch_priority(&b, v);
+		h_insert(order, &prio[v], d_less_pri, d_hash);
+	}
+
+	r = 0;
+	while (!h_empty(order)) {
+		v = ((SpItem *) h_del_max_pri(order, d_less_pri, d_hash))->index;
+		p = ch_priority(&b, v);
+		if (p == CORE_PRIO && prio[v].pri == CORE_PRIO) {
+			/* Só restam vértices do núcleo. */
+			break;
+		}
+		if (p > prio[v].pri) {
+			prio[v].pri = p;
+			h_insert(order, &prio[v], d_less_pri, d_hash);
+			continue;
+		}
+
+		/* A prioridade acabou de ser calculada com o estado atual, pelo
+		 * que os atalhos pendentes são os de v. */
+		ch_apply(&b, v);
+		ch_remove(&b, v);
+		ch->rank[v] = r++;
+	}
+	h_free(order);
+	free(prio);
+
+	/* Os vértices do núcleo ficam com as últimas ordens, e as suas listas
+	 * têm apenas vizinhos do núcleo (os outros já foram retirados). */
+	for (i = 0; i < size; i++) {
+		v = g_get_index(g, i);
+		if (ch->rank[v] == -1) {
+			ch->rank[v] = r++;
+		}
+	}
+
+	/* Compactar as arestas ascendentes. */
+	ch->first = (int *) emalloc((size + 1) * sizeof(int));
+	ch->first[0] = 0;
+	for (v = 0; v < size; v++) {
+		ch->first[v+1] = ch->first[v] + b.deg[v];
+	}
+	ch->up = (ChEdge *) emalloc((ch->first[size] + 1) * sizeof(ChEdge));
+	for (v = 0; v < size; v++) {
+		for (i = 0; i < b.deg[v]; i++) {
+			ch->up[ch->first[v] + i] = b.adj[v][i];
+		}
+		free(b.adj[v]);
+	}
+
+	free(b.adj);
+	free(b.deg);
+	free(b.cap);
+	free(b.deleted);
+	free(b.touched);
+	free(b.target);
+	free(b.tdist);
+	free(b.pend);
+	free(b.wdist);
+	free(b.items);
+	h_free(b.heap);
+
+	return ch;
+}
+
+/**
+ * @brief Liberta uma lista de hierarquias.
+ *
+ * @param list Lista de hierarquias.
+ */
+void ch_free(Hierarchy *list)
+{
+	Hierarchy *tmp;
+
+	while (list) {
+		tmp = list->next;
+		free(list->rank);
+		free(list->first);
+		free(list->up);
+		free(list);
+		list = tmp;
+	}
+}
+
+/**
+ * @brief Insere uma hierarquia numa lista de hierarquias.
+ *
+ * @param list Lista de hierarquias.
+ * @param ch Hierarquia a inserir.
+ * @return Nova cabeça da lista.
+ */
+Hierarchy *ch_add(Hierarchy *list, Hierarchy *ch)
+{
+	ch->next = list;
+	return ch;
+}
+
+/**
+ * @brief Procura a hierarquia de um peso máximo de arestas.
+ * @details Ao contrário das tabelas de marcos, uma hierarquia só serve o
+ *	peso máximo para o qual foi construída.
+ *
+ * @param list Lista de hierarquias.
+ * @param max_weight Peso máximo de arestas.
+ * @return Hierarquia, ou NULL se não existir.
+ */
+Hierarchy *ch_select(Hierarchy *list, unsigned short max_weight)
+{
+	while (list != NULL && list->max_weight != max_weight) {
+		list = list->next;
+	}
+
+	return list;
+}
+
+/**
+ * @brief Cria tabelas de trabalho vazias para ch_query().
+ *
+ * @return Tabelas de trabalho.
+ */
+ChScratch *ch_scratch_init(void)
+{
+	ChScratch *s = (ChScratch *) ecalloc(1, sizeof(ChScratch));
+
+	return s;
+}
+
+/**
+ * @brief Liberta as tabelas de trabalho de ch_query().
+ *
+ * @param s Tabelas de trabalho.
+ */
+void ch_scratch_free(ChScratch *s)
+{
+	int k;
+
+	for (k = 0; k < 2; k++) {
+		free(s->dist[k]);
+		free(s->parent[k]);
+		free(s->pmid[k]);
+		free(s->items[k]);
+		if (s->heap[k] != NULL) {
+			h_free(s->heap[k]);
+		}
+	}
+	free(s->touched);
+	free(s);
+}
+
+/**
+ * @brief Garante que as tabelas de trabalho servem uma hierarquia de size
+ *	vértices.
+ * @details As distâncias ficam todas a MAX_WT; cada consulta repõe as que
+ *	alterou.
+ *
+ * @param s Tabelas de trabalho.
+ * @param size Número de vértices.
+ */
+static void ch_scratch_grow(ChScratch *s, int size)
+{
+	int k, v;
+
+	if (size <= s->size) {
+		return;
+	}
+
+	for (k = 0; k < 2; k++) {
+		free(s->dist[k]);
+		free(s->parent[k]);
+		free(s->pmid[k]);
+		free(s->items[k]);
+		if (s->heap[k] != NULL) {
+			h_free(s->heap[k]);
+		}
+		s->dist[k] = (int *) emalloc(size * sizeof(int));
+		s->parent[k] = (int *) emalloc(size * sizeof(int));
+		s->pmid[k] = (int *) emalloc(size * sizeof(int));
+		s->items[k] = (SpItem *) emalloc(size * sizeof(SpItem));
+		s->heap[k] = h_init(size);
+		for (v = 0; v < size; v++) {
+			s->dist[k][v] = MAX_WT;
+			s->items[k][v].index = v;
+		}
+	}
+	free(s->touched);
+	s->touched = (int *) emalloc(2 * size * sizeof(int));
+	s->ntouched = 0;
+	s->size = size;
+}
+
+/**
+ * @brief Fixa o vértice x na pesquisa ascendente da direção dir,
+ *	relaxando as suas arestas ascendentes.
+ *
+ * @param ch Hierarquia.
+ * @param s Tabelas de trabalho.
+ * @param dir 0 a partir da origem, 1 a partir do destino.
+ * @param x Vértice fixado.
+ * @param cnt Contadores da pesquisa.
+ */
+static void ch_relax(Hierarchy *ch, ChScratch *s, int dir, int x, Counters *cnt)
+{
+	int *dist = s->dist[dir];
+	int y, i, nd;
+	bool in_heap;
+
+	cnt->scanned += ch->first[x+1] - ch->first[x];
+	for (i = ch->first[x]; i < ch->first[x+1]; i++) {
+		y = ch->up[i].to;
+		nd = dist[x] + ch->up[i].weight;
+		if (nd < dist[y]) {
+			in_heap = (dist[y] != MAX_WT);
+			if (!in_heap) {
+				s->touched[s->ntouched++] = y;
+			}
+			dist[y] = nd;
+			s->items[dir][y].pri = nd;
+			s->parent[dir][y] = x;
+			s->pmid[dir][y] = ch->up[i].middle;
+			if (in_heap) {
+				h_inc_pri(s->heap[dir], &(s->items[dir][y]), d_less_pri, d_hash);
+				cnt->decreases++;
+			}
+			else {
+				h_insert(s->heap[dir], &(s->items[dir][y]), d_less_pri, d_hash);
+				cnt->inserts++;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Pesquisa bidirecional ascendente.
+ * @details As duas pesquisas alternam; cada vértice fixado que a outra
+ *	pesquisa já alcançou é um ponto de encontro candidato. Uma direção
+ *	termina quando a sua menor distância já não pode melhorar o melhor
+ *	caminho encontrado.
+ *
+ * @param ch Hierarquia.
+ * @param s Tabelas de trabalho.
+ * @param src Índice do vértice de origem.
+ * @param dst Índice do vértice de destino.
+ * @param best Comprimento do melhor caminho (MAX_WT se não existir).
+ * @param budget Orçamento da pesquisa, ou NULL.
+ * @param cnt Contadores da pesquisa.
+ * @return Ponto de encontro do melhor caminho, -1 se não existir ou se o
+ *	orçamento se esgotar.
+ */
+static int ch_search(Hierarchy *ch, ChScratch *s, int src, int dst, int *best,
+		Budget *budget, Counters *cnt)
+{
+	int meet = -1;
+	int dir, x;
+	bool done[2];
+
+	s->dist[0][src] = s->items[0][src].pri = 0;
+	s->dist[1][dst] = s->items[1][dst].pri = 0;
+	s->parent[0][src] = -1;
+	s->parent[1][dst] = -1;
+	s->touched[s->ntouched++] = src;
+	s->touched[s->ntouched++] = dst;
+	h_insert(s->heap[0], &(s->items[0][src]), d_less_pri, d_hash);
+	h_insert(s->heap[1], &(s->items[1][dst]), d_less_pri, d_hash);
+	cnt->inserts += 2;
+	done[0] = done[1] = false;
+	*best = MAX_WT;
+
+	for (dir = 0; !done[0] || !done[1]; dir = 1 - dir) {
+		if (done[dir]) continue;
+		if (h_empty(s->heap[dir])) {
+			done[dir] = true;
+			continue;
+		}
+
+		x = ((SpItem *) h_del_max_pri(s->heap[dir], d_less_pri, d_hash))->index;
+		cnt->pops++;
+		if (budget != NULL && budget_spent(budget, cnt->settled + 1)) {
+			meet = -1;
+			break;
+		}
+		if (s->dist[dir][x] >= *best) {
+			done[dir] = true;
+			continue;
+		}
+		if (s->dist[1-dir][x] != MAX_WT && s->dist[dir][x] + s->dist[1-dir][x] < *best) {
+			*best = s->dist[dir][x] + s->dist[1-dir][x];
+			meet = x;
+		}
+		cnt->settled++;
+		ch_relax(ch, s, dir, x, cnt);
+	}
+
+	h_clear(s->heap[0]);
+	h_clear(s->heap[1]);
+
+	return meet;
+}
+
+/**
+ * @brief Vértice do meio da aresta a-b da hierarquia.
+ * @details A aresta está guardada nas arestas ascendentes do vértice de
+ *	menor ordem.
+ *
+ * @param ch Hierarquia.
+ * @param a Vértice.
+ * @param b Vértice.
+ * @return Vértice do meio, -1 se a aresta for original.
+ */
+static int ch_middle(Hierarchy *ch, int a, int b)
+{
+	int i, low = a, high = b;
+
+	if (ch->rank[a] > ch->rank[b]) {
+		low = b;
+		high = a;
+	}
+	for (i = ch->first[low]; i < ch->first[low+1]; i++) {
+		if (ch->up[i].to == high) {
+			return ch->up[i].middle;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * @brief Expande a aresta a-b nas arestas originais, marcando na árvore de
+ *	caminho st o antecessor de cada vértice, de a para b.
+ *
+ * @param ch Hierarquia.
+ * @param a Vértice de partida.
+ * @param b Vértice de chegada.
+ * @param middle Vértice do meio da aresta a-b, -1 se for original.
+ * @param st Árvore de caminho.
+ */
+static void ch_unpack(Hierarchy *ch, int a, int b, int middle, int *st)
+{
+	if (middle == -1) {
+		st[b] = a;
+		return;
+	}
+	ch_unpack(ch, a, middle, ch_middle(ch, a, middle), st);
+	ch_unpack(ch, middle, b, ch_middle(ch, middle, b), st);
+}
+
+/**
+ * @brief Encontra o caminho mais curto entre src e dst na hierarquia.
+ * @details O caminho é escrito na árvore de caminho st tal como
+ *	shortest_path() o faria (st[src] = -1 e st[v] é o antecessor de v),
+ *	para ser impresso por solve_problem(). Apenas os vértices do caminho são
+ *	escritos; st[dst] é -1 se não houver caminho.
+ *
+ * @param ch Hierarquia.
+ * @param s Tabelas de trabalho da consulta (ver ch_scratch_init()).
+ * @param src Índice do vértice de origem.
+ * @param dst Índice do vértice de destino.
+ * @param st Árvore de caminho.
+ * @param budget Orçamento da pesquisa, ou NULL. Se se esgotar, o resultado
+ *	é -1 e budget->exceeded fica verdadeiro.
+ * @param cnt Contadores da pesquisa (postos a zero no início), ou NULL.
+ * @return Comprimento do caminho, -1 se não existir.
+ */
+int ch_query(Hierarchy *ch, ChScratch *s, int src, int dst, int *st, Budget *budget,
+		Counters *cnt)
+{
+	int best, meet;
+	int x, y, i;
+	Counters none; /* Contadores descartados, se cnt for NULL. */
+
+	if (cnt == NULL) {
+		cnt = &none;
+	}
+	memset(cnt, 0, sizeof(Counters));
+
+	ch_scratch_grow(s, ch->size);
+	meet = ch_search(ch, s, src, dst, &best, budget, cnt);
+
+	st[src] = -1;
+	st[dst] = -1;
+	if (meet != -1) {
+		/* Da origem ao ponto de encontro: a cadeia de antecessores está
+		 * invertida, pelo que se expande de meet para trás. */
+		for (x = meet; x != src; x = y) {
+			y = s->parent[0][x];
+			ch_unpack(ch, y, x, s->pmid[0][x], st);
+		}
+		/* Do ponto de encontro ao destino. */
+		for (x = meet; x != dst; x = y) {
+			y = s->parent[1][x];
+			ch_unpack(ch, x, y, s->pmid[1][x], st);
+		}
+	}
+
+	for (i = 0; i < s->ntouched; i++) {
+		s->dist[0][s->touched[i]] = MAX_WT;
+		s->dist[1][s->touched[i]] = MAX_WT;
+	}
+	s->ntouched = 0;
+
+	return meet == -1 ? -1 : best;
+}
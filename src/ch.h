@@ -0,0 +1,42 @@
+/**
+ * @file ch.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Hierarquias de contração (contraction hierarchies).
+ * @details
+ *	Pré-processamento: os vértices do grafo são contraídos um a um, por
+ *	ordem de diferença de arestas; ao contrair v, cada par de vizinhos u, w
+ *	cujo caminho mais curto passa por v (não há caminho testemunha) recebe
+ *	um atalho u-w. No fim, cada vértice guarda apenas as arestas para
+ *	vértices mais importantes (contraídos depois).
+ *
+ *	Consulta: pesquisa de Dijkstra bidirecional apenas por arestas
+ *	ascendentes; os atalhos do caminho encontrado são depois expandidos
+ *	nas palavras intermédias.
+ *
+ *	Como os atalhos dependem das arestas admissíveis, cada hierarquia
+ *	corresponde a um único peso máximo de arestas.
+ */
+#ifndef _CH_H
+#define _CH_H
+
+#include "graph.h"
+#include "dijkstra.h"
+
+/* Tabelas de trabalho de ch_query(), uma por quem consulta. */
+typedef struct _ChScratch ChScratch;
+
+Hierarchy *ch_build(Graph *g, unsigned short max_weight);
+void ch_free(Hierarchy *list);
+
+Hierarchy *ch_add(Hierarchy *list, Hierarchy *ch);
+Hierarchy *ch_select(Hierarchy *list, unsigned short max_weight);
+
+ChScratch *ch_scratch_init(void);
+void ch_scratch_free(ChScratch *s);
+int ch_query(Hierarchy *ch, ChScratch *s, int src, int dst, int *st, Budget *budget,
+		Counters *cnt);
+
+#endif
@@ -12,6 +12,14 @@
 /* Tamanho máximo das várias tabelas e buffers,
  * pois dependem todos da maior palavra existente no dicionário. */
 #define MAX_WORD_SIZE 64
+/* Número máximo de vértices de um grafo (índices em unsigned short). */
+#define MAX_VERTICES 65535
 #define OUT_EXT ".path"
 
+/* Códigos escritos no .path em vez do custo quando não há solução. */
+#define NO_PATH -1 /* As palavras não estão ligadas. */
+#define BUDGET_EXCEEDED -2 /* A pesquisa excedeu o seu orçamento. */
+#define DEADLINE_EXCEEDED -3 /* O prazo do lote terminou antes do problema. */
+#define INVALID_PROBLEM -4 /* Linha de problema mal formada (modo servidor). */
+
 #endif
@@ -0,0 +1,236 @@
+/**
+ * @file daemon.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Modo daemon: servir problemas numa socket Unix.
+ * @details
+ *	Um número fixo de fios de execução (workers) aceita ligações na mesma
+ *	socket; cada um serve uma ligação de cada vez, do princípio ao fim, com
+ *	as suas próprias tabelas de trabalho (Solver). O fio principal só espera
+ *	por SIGINT ou SIGTERM para terminar.
+ *
+ *	Os grafos são partilhados (ver lock.c): as pesquisas leem-nos em
+ *	conjunto, e as construções (raras, só no primeiro problema de cada
+ *	tamanho e limiar) são feitas com acesso exclusivo.
+ */
+/* Sockets, fios de execução e sigwait() são POSIX, não fazem parte de C89. */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "daemon.h"
+#include "file.h"
+#include "utils.h"
+#include "lock.h"
+
+/* Ligações à espera de accept(), para além de uma por worker. */
+#define BACKLOG 64
+
+/**
+ * @brief Fio de execução que serve ligações.
+ * @details thread: identificador do fio
+ *	fd: ligação que está a servir, -1 se estiver à espera de uma
+ */
+typedef struct _Worker {
+	pthread_t thread;
+	int fd;
+} Worker;
+
+/* Estado do daemon, partilhado pelos workers. Só há um daemon por
+ * processo. */
+/* Protege stopping e Worker.fd. */
+static pthread_mutex_t conn_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool stopping = false;
+static int listen_fd = -1;
+static Graph **dm_graphs = NULL;
+
+/**
+ * @brief Serve uma ligação até o cliente a fechar.
+ *
+ * @param fd Ligação aceite.
+ * @param so Estado de quem resolve, do worker.
+ */
+static void dm_client(int fd, Solver *so)
+{
+	FILE *in, *out;
+	int fd_out;
+
+	/* Um FILE para cada sentido, para que fclose() não feche o outro. */
+	if ((fd_out = dup(fd)) == -1) {
+		close(fd);
+		return;
+	}
+	in = fdopen(fd, "r");
+	out = fdopen(fd_out, "w");
+	if (in == NULL || out == NULL) {
+		if (in != NULL) fclose(in); else close(fd);
+		if (out != NULL) fclose(out); else close(fd_out);
+		return;
+	}
+
+	serve(in, out, dm_graphs, so);
+
+	fclose(in);
+	fclose(out);
+}
+
+/**
+ * @brief Ciclo de um worker: aceitar e servir ligações até o daemon parar.
+ *
+ * @param arg Worker (Worker *).
+ * @return NULL.
+ */
+static void *dm_worker(void *arg)
+{
+	Worker *w = (Worker *) arg;
+	Solver *so = so_init(lk_lock, lk_unlock);
+	int fd;
+
+	for (;;) {
+		fd = accept(listen_fd, NULL, NULL);
+		if (fd == -1) {
+			if (errno == EINTR || errno == ECONNABORTED) continue;
+			break;
+		}
+
+		pthread_mutex_lock(&conn_lock);
+		if (stopping) {
+			pthread_mutex_unlock(&conn_lock);
+			close(fd);
+			break;
+		}
+		w->fd = fd;
+		pthread_mutex_unlock(&conn_lock);
+
+		dm_client(fd, so);
+
+		pthread_mutex_lock(&conn_lock);
+		w->fd = -1;
+		pthread_mutex_unlock(&conn_lock);
+	}
+
+	so_free(so);
+	return NULL;
+}
+
+/**
+ * @brief Acorda um worker parado em accept(), ligando-se à socket.
+ *
+ * @param addr Endereço da socket.
+ */
+static void dm_wake(struct sockaddr_un *addr)
+{
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	if (fd != -1) {
+		connect(fd, (struct sockaddr *) addr, sizeof(*addr));
+		close(fd);
+	}
+}
+
+/**
+ * @brief Corre o daemon até receber SIGINT ou SIGTERM.
+ * @details Se já existir uma socket em path (de um daemon anterior) é
+ *	substituída; qualquer outro ficheiro é deixado intacto e o daemon não
+ *	arranca. Ao terminar, as ligações abertas são fechadas, os workers
+ *	esperados e a socket apagada.
+ *
+ * @param path Caminho da socket Unix.
+ * @param graphs Tabela de grafos, de read_dic().
+ * @param workers Número de workers (ligações servidas ao mesmo tempo).
+ * @return EXIT_SUCCESS, ou EXIT_FAILURE se não foi possível criar a socket.
+ */
+int daemon_run(const char *path, Graph **graphs, int workers)
+{
+	struct sockaddr_un addr;
+	struct stat st;
+	sigset_t stop;
+	Worker *w;
+	int i, sig;
+
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "Erro: caminho da socket comprido de mais: %s\n", path);
+		return EXIT_FAILURE;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	if (lstat(path, &st) == 0) {
+		if (!S_ISSOCK(st.st_mode)) {
+			fprintf(stderr, "Erro: %s existe e não é uma socket.\n", path);
+			return EXIT_FAILURE;
+		}
+		unlink(path);
+	}
+
+	if ((listen_fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1) {
+		perror("socket");
+		return EXIT_FAILURE;
+	}
+	if (bind(listen_fd, (struct sockaddr *) &addr, sizeof(addr)) == -1
+			|| listen(listen_fd, BACKLOG + workers) == -1) {
+		perror(path);
+		close(listen_fd);
+		return EXIT_FAILURE;
+	}
+
+	lk_init();
+	dm_graphs = graphs;
+
+	/* Os sinais de paragem são recebidos apenas por sigwait(), no fio
+	 * principal; a máscara é herdada pelos workers. Um cliente que fecha
+	 * a ligação a meio não deve matar o processo (SIGPIPE). */
+	signal(SIGPIPE, SIG_IGN);
+	sigemptyset(&stop);
+	sigaddset(&stop, SIGINT);
+	sigaddset(&stop, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &stop, NULL);
+
+	w = (Worker *) emalloc(workers * sizeof(Worker));
+	for (i = 0; i < workers; i++) {
+		w[i].fd = -1;
+		if (pthread_create(&w[i].thread, NULL, dm_worker, &w[i]) != 0) {
+			fprintf(stderr, "Erro: impossível criar worker.\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	fprintf(stderr, "wordmorph: a servir em %s com %d workers\n", path, workers);
+	sigwait(&stop, &sig);
+
+	/* Parar: fechar as ligações abertas e acordar os workers que estão
+	 * em accept(), um por um. */
+	pthread_mutex_lock(&conn_lock);
+	stopping = true;
+	for (i = 0; i < workers; i++) {
+		if (w[i].fd != -1) {
+			shutdown(w[i].fd, SHUT_RDWR);
+		}
+	}
+	pthread_mutex_unlock(&conn_lock);
+	for (i = 0; i < workers; i++) {
+		dm_wake(&addr);
+	}
+	for (i = 0; i < workers; i++) {
+		pthread_join(w[i].thread, NULL);
+	}
+
+	free(w);
+	close(listen_fd);
+	unlink(path);
+	lk_destroy();
+
+	return EXIT_SUCCESS;
+}
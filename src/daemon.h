@@ -0,0 +1,21 @@
+/**
+ * @file daemon.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Modo daemon: servir problemas numa socket Unix.
+ * @details
+ *	Vários clientes locais partilham uma única cópia dos grafos em memória.
+ *	Cada ligação fala o protocolo do modo servidor (ver serve()): uma linha
+ *	"palavra1 palavra2 permutações" por problema, um bloco igual ao do
+ *	.path por resposta.
+ */
+#ifndef _DAEMON_H
+#define _DAEMON_H
+
+#include "graph.h"
+
+int daemon_run(const char *path, Graph **graphs, int workers);
+
+#endif
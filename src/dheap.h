@@ -0,0 +1,28 @@
+/**
+ * @file dheap.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Acervos 4-ários de vértices com chaves inteiras, da pesquisa de
+ *	caminhos mais curtos.
+ * @details
+ *	Instâncias de heapgen.h: a menor chave sai primeiro e os valores são
+ *	os índices dos vértices. DHeap (funções dh_*()) é indexado e diminui
+ *	chaves; LHeap (funções lh_*()) aceita cópias do mesmo vértice, para a
+ *	fila com remoção preguiçosa (--queue=lazy).
+ */
+#ifndef _DHEAP_H
+#define _DHEAP_H
+
+#include "heapgen.h"
+
+/* Número de filhos de cada nó. */
+#define DH_ARITY 4
+
+#define DH_LESS(a, b) ((a) < (b))
+
+HEAP_GENERATE(dh, DHeap, int, DH_LESS, DH_ARITY)
+LAZY_HEAP_GENERATE(lh, LHeap, int, DH_LESS, DH_ARITY)
+
+#endif
@@ -8,90 +8,218 @@
  * curtos em grafos.
  */
 #include <stdlib.h>
+#include <string.h>
 
 #include "dijkstra.h"
 #include "utils.h"
 #include "graph.h"
-#include "heap.h"
+#include "dheap.h"
+#include "radix.h"
+#include "bucket.h"
+#include "landmark.h"
+#include "packed.h"
 
-/* wt é a tabela de distâncias utilizada pela função shortest_path().
- * É global privada deste ficheiro dijkstra.c, para facilitar
- * o acesso à variável pela função d_less_pri(), chamada em heap.c.
+/**
+ * @brief Tabelas de trabalho de shortest_path().
+ * @details size: número de vértices para que as tabelas estão alocadas
+ *	wt: tabela de distâncias, devolvida por shortest_path() e válida até à
+ *	próxima pesquisa com as mesmas tabelas
+ *	queue: fila usada por shortest_path() (SP_QUEUE_*)
+ *	heap: fila prioritária de vértices; a chave é wt em Dijkstra simples
+ *	e, em A*, a distância à origem mais o limite inferior dado pelos
+ *	marcos até ao destino. É também a fila da cache de árvores, seja qual
+ *	for queue.
+ *	lazy, radix, bucket: filas com cópias, com as mesmas chaves que heap
+ *	(SP_QUEUE_LAZY, SP_QUEUE_RADIX e SP_QUEUE_BUCKET); só existe a de
+ *	queue
+ *	done: mapa de bits dos vértices fixados (filas com cópias)
  *
- * Este ponteiro é devolvido pela função shortest_path e utilizado em file.c.
- * No entanto, da próxima vez que shortest_path() será chamada,
- * esta variável será realocada e reinicializada, evitando quaisquer problemas.
- * No fim, é libertada em file.c, solve_pal(). */
-static int *wt = NULL;
+ *	As tabelas crescem com o maior grafo pesquisado e são reaproveitadas
+ *	entre pesquisas. Cada fio de execução tem as suas.
+ */
+struct _SpScratch {
+	int size;
+	int *wt;
+	int queue;
+	DHeap *heap;
+	LHeap *lazy;
+	RadixHeap *radix;
+	BucketQueue *bucket;
+	unsigned char *done;
+};
+
+/* Nomes das filas, pela ordem de SP_QUEUE_*. */
+static const char *queue_names[] = {"heap", "lazy", "radix", "bucket"};
 
 /**
- * @brief Encontra o caminho mais curto entre os vértices src e dst no grafo g.
- * @details Implementa o algoritmo de Dijkstra fonte-destino,
- *	recorrendo a uma fila prioritária implementada por acervo (heap).
- *	Inicialmente, o vértice de origem é inserido na fila, para ser
- *	retirado na primeira iteração do ciclo principal, sendo inseridos
- *	agora na fila apenas vértices adjacentes à origem e assim em diante.
+ * @brief Cria tabelas de trabalho vazias para shortest_path().
  *
- * @param g Grafo a procurar.
- * @param src Índice do vértice de origem.
- * @param dst Índice do vértice de destino.
- * @param st Árvore de caminhos.
- * @param max_weight Peso máximo de arestas a considerar.
- *
- * @return wt Tabela de distâncias.
+ * @param queue Fila prioritária das pesquisas (SP_QUEUE_*).
+ * @return Tabelas de trabalho.
  */
-int *shortest_path(Graph *g, int src, int dst, int *st, unsigned short max_weight)
+SpScratch *sp_scratch_init(int queue)
 {
-	int v; /* Indíce de um vértice */
-	int v_adj; /* Indíce de um vértice adjacente a v */
-	Edge *l; /* Aresta de v para v_adj */
-	int i;
-	unsigned short w_v_adj;
-	int *array; /* Tabela ajudante para o tipo abstrato a usar na fila. */
-	bool in_heap;
+	SpScratch *s = (SpScratch *) emalloc(sizeof(SpScratch));
 
-	/* Inicializar fila. */
-	Heap *heap = h_init(g_get_size(g));
+	s->size = 0;
+	s->wt = NULL;
+	s->queue = queue;
+	s->heap = NULL;
+	s->lazy = NULL;
+	s->radix = NULL;
+	s->bucket = NULL;
+	s->done = NULL;
 
-	/* Realocar wt (global para este ficheiro) para o tamanho corrente. */
-	wt = realloc(wt, g_get_size(g) * sizeof(int));
+	return s;
+}
 
-	/* Inicializar árvore de caminho e array de distâncias. */
-	for (v = 0; v < g_get_size(g); v++) {
-		st[v] = -1;
-		wt[v] = MAX_WT;
+/**
+ * @brief Liberta as tabelas de trabalho de shortest_path().
+ * @details A tabela de distâncias devolvida pela última pesquisa deixa de
+ *	ser válida.
+ *
+ * @param s Tabelas de trabalho.
+ */
+void sp_scratch_free(SpScratch *s)
+{
+	free(s->wt);
+	if (s->heap != NULL) {
+		dh_free(s->heap);
+	}
+	if (s->lazy != NULL) {
+		lh_free(s->lazy);
+	}
+	if (s->radix != NULL) {
+		rh_free(s->radix);
 	}
+	if (s->bucket != NULL) {
+		bq_free(s->bucket);
+	}
+	free(s->done);
+	free(s);
+}
 
-	/* Inicializar a fila apenas com o vértice de origem */
-	/* Items da fila são ints (correspondentes a indíces dos vértices no grafo) */
-	array = (int *) emalloc(g_get_size(g) * sizeof(int));
-	for (i = 0; i < g_get_size(g); i++) {
-		array[i] = i;
+/**
+ * @brief Garante que as tabelas de trabalho servem um grafo de size vértices.
+ * @details A fila com cópias começa com espaço para size elementos e
+ *	cresce, se for preciso, durante as pesquisas.
+ *
+ * @param s Tabelas de trabalho.
+ * @param size Número de vértices do grafo.
+ */
+static void sp_scratch_grow(SpScratch *s, int size)
+{
+	if (size <= s->size) {
+		return;
 	}
-	h_insert(heap, &array[src], d_less_pri, d_hash);
 
-	wt[src] = 0;
+	free(s->wt);
+	if (s->heap != NULL) {
+		dh_free(s->heap);
+	}
+	s->wt = (int *) emalloc(size * sizeof(int));
+	s->heap = dh_init(size);
+	if (s->queue == SP_QUEUE_HEAP) {
+		s->size = size;
+		return;
+	}
+
+	free(s->done);
+	s->done = (unsigned char *) emalloc((size + 7) / 8);
+	if (s->queue == SP_QUEUE_LAZY) {
+		if (s->lazy != NULL) {
+			lh_free(s->lazy);
+		}
+		s->lazy = lh_init(size);
+	}
+	/* As outras não dependem do tamanho do grafo. */
+	else if (s->queue == SP_QUEUE_RADIX && s->radix == NULL) {
+		s->radix = rh_init();
+	}
+	else if (s->queue == SP_QUEUE_BUCKET && s->bucket == NULL) {
+		s->bucket = bq_init();
+	}
+	s->size = size;
+}
+
+/**
+ * @brief Ciclo principal de shortest_path(): retira vértices da fila e
+ *	percorre as suas listas de adjacências até o destino sair da fila, a
+ *	fila se esgotar ou o orçamento acabar.
+ *
+ * @param s Tabelas de trabalho, com a fila.
+ * @param g Grafo a procurar.
+ * @param v Vértice já retirado da fila e ainda por percorrer, ou -1.
+ * @param dst Índice do vértice de destino, ou -1.
+ * @param wt Tabela de distâncias.
+ * @param st Árvore de caminhos.
+ * @param max_weight Peso máximo de arestas a considerar.
+ * @param lm Tabela de marcos para A*, ou NULL.
+ * @param budget Orçamento da pesquisa, ou NULL.
+ * @param cnt Contadores da pesquisa.
+ *
+ * @return Último vértice retirado da fila e não percorrido (o destino, ou
+ *	aquele em que o orçamento acabou), ou -1 se a fila se esgotou.
+ */
+static int sp_run(SpScratch *s, Graph *g, int v, int dst, int *wt, int *st,
+		unsigned short max_weight, Landmarks *lm, Budget *budget, Counters *cnt)
+{
+	int v_adj; /* Indíce de um vértice adjacente a v */
+	PkIter l; /* Lista de adjacências de v (ver packed.h) */
+	unsigned short i_v_adj, w_v_adj;
+	bool in_heap;
+	int h; /* Limite inferior da distância de v_adj ao destino. */
+	int pri; /* Nova chave de v_adj na fila. */
+	DHeap *heap = s->heap; /* Fila prioritária. */
+
 	/* Colocar na heap os vértices adjacentes e calcular distâncias. */
-	while (!h_empty(heap)) {
-		v = *((int *) h_del_max_pri(heap, d_less_pri, d_hash));
+	for (;;) {
+		if (v == -1) {
+			if (dh_empty(heap)) return -1;
+			v = dh_pop(heap);
+			cnt->pops++;
+		}
 
 		/* Parar quando o vértice de destino sai da fila prioritária,
 		 * pois garantimos que temos o caminho mais curto até lá. */
-		if (v == dst) break;
+		if (v == dst) return v;
+
+		if (budget != NULL && budget_spent(budget, cnt->settled + 1)) {
+			return v;
+		}
+		cnt->settled++;
 
 		/* Percorrer a lista de adjacências de v. */
-		for (l = v_get_adj(g_get_vertex(g, v)); l != NULL; l = e_get_next(l)) {
-			w_v_adj = e_get_weight(l);
+		for (pk_begin(g, v, &l); pk_next(&l, &i_v_adj, &w_v_adj); ) {
+			cnt->scanned++;
 			/* Ignorar arestas de peso maior ao peso máximo que estamos
 			 * a considerar. */
-			if (w_v_adj > max_weight) continue;
+			if (w_v_adj > max_weight) {
+				cnt->filtered++;
+				continue;
+			}
 
-			v_adj = e_get_index(l);
+			v_adj = i_v_adj;
 			if (wt[v] + w_v_adj < wt[v_adj]) {
 				/* A partir de v conseguimos minimizar a distância a v_adj,
 				* previamente calculada. */
 				in_heap = (wt[v_adj] != MAX_WT);
 
+				if (lm == NULL) {
+					pri = wt[v] + w_v_adj;
+				}
+				else if (in_heap) {
+					/* O limite de v_adj não muda: a prioridade desce
+					 * tanto quanto a distância. */
+					pri = dh_key(heap, v_adj) - (wt[v_adj] - (wt[v] + w_v_adj));
+				}
+				else {
+					h = lm_bound(lm, v_adj, dst);
+					/* v_adj não alcança o destino. */
+					if (h == MAX_WT) continue;
+					pri = wt[v] + w_v_adj + h;
+				}
+
 				/* Atualizar distância com o novo valor. */
 				wt[v_adj] = wt[v] + w_v_adj;
 				/* Marcar v como antecessor de v_adj. */
@@ -100,37 +228,550 @@ int *shortest_path(Graph *g, int src, int dst, int *st, unsigned short max_weigh
 				if (in_heap) {
 					/* ... Se v_adj já estiver na fila, incrementamos a sua
 					 * prioridade. */
-					h_inc_pri(heap, &(array[v_adj]), d_less_pri, d_hash);
+					dh_decrease(heap, v_adj, pri);
+					cnt->decreases++;
 				}
 				else {
 					/* Senão, inserimo-lo nesta. */
-					h_insert(heap, &(array[v_adj]), d_less_pri, d_hash);
+					dh_insert(heap, v_adj, pri);
+					cnt->inserts++;
 				}
 			}
 		}
+		v = -1;
 	}
+}
 
-	/* Libertar a fila e a array temporária. */
-	h_free(heap);
-	free(array);
+/**
+ * @brief Insere uma cópia de v na fila com cópias das tabelas de trabalho.
+ */
+static void q_push(SpScratch *s, int v, int key)
+{
+	switch (s->queue) {
+	case SP_QUEUE_RADIX: rh_push(s->radix, v, key); break;
+	case SP_QUEUE_BUCKET: bq_push(s->bucket, v, key); break;
+	default: lh_push(s->lazy, v, key);
+	}
+}
+
+/**
+ * @brief Retira da fila com cópias um vértice de menor chave.
+ *
+ * @return Vértice, ou -1 se a fila estiver vazia.
+ */
+static int q_pop(SpScratch *s)
+{
+	switch (s->queue) {
+	case SP_QUEUE_RADIX: return rh_empty(s->radix) ? -1 : rh_pop(s->radix);
+	case SP_QUEUE_BUCKET: return bq_empty(s->bucket) ? -1 : bq_pop(s->bucket);
+	default: return lh_empty(s->lazy) ? -1 : lh_pop(s->lazy);
+	}
+}
+
+/**
+ * @brief Como sp_run(), com uma fila com cópias (SP_QUEUE_LAZY,
+ *	SP_QUEUE_RADIX ou SP_QUEUE_BUCKET).
+ * @details Quando a distância de um vértice que já está na fila diminui,
+ *	insere-se outra cópia com a nova chave, em vez de a diminuir. A cópia
+ *	de menor chave sai primeiro e fixa o vértice; as outras, quando saem,
+ *	são descartadas (cnt->stale). Com limites consistentes, um vértice
+ *	fixado nunca volta a melhorar.
+ *
+ *	Poupa a tabela de posições e as suas escritas em cada troca, à custa
+ *	de uma fila maior: compensa quando há poucas reduções por vértice.
+ *	As chaves retiradas nunca descem, o que permite as filas radix e de
+ *	baldes.
+ *
+ * @return Vértice de destino, ou aquele em que o orçamento acabou, ou -1
+ *	se a fila se esgotou.
+ */
+static int sp_run_lazy(SpScratch *s, Graph *g, int dst, int *wt, int *st,
+		unsigned short max_weight, Landmarks *lm, Budget *budget, Counters *cnt)
+{
+	int v, v_adj;
+	PkIter l;
+	unsigned short i_v_adj, w_v_adj;
+	int h; /* Limite inferior da distância de v_adj ao destino. */
+	unsigned char *done = s->done;
+
+	while ((v = q_pop(s)) != -1) {
+		cnt->pops++;
+		if (done[v / 8] & (1 << (v % 8))) {
+			cnt->stale++;
+			continue;
+		}
+		done[v / 8] |= 1 << (v % 8);
+
+		if (v == dst) return v;
+
+		if (budget != NULL && budget_spent(budget, cnt->settled + 1)) {
+			return v;
+		}
+		cnt->settled++;
+
+		for (pk_begin(g, v, &l); pk_next(&l, &i_v_adj, &w_v_adj); ) {
+			cnt->scanned++;
+			if (w_v_adj > max_weight) {
+				cnt->filtered++;
+				continue;
+			}
+
+			v_adj = i_v_adj;
+			if (wt[v] + w_v_adj < wt[v_adj]) {
+				h = 0;
+				if (lm != NULL && (h = lm_bound(lm, v_adj, dst)) == MAX_WT) {
+					continue;
+				}
+
+				if (wt[v_adj] != MAX_WT) {
+					cnt->decreases++;
+				}
+				else {
+					cnt->inserts++;
+				}
+				wt[v_adj] = wt[v] + w_v_adj;
+				st[v_adj] = v;
+				q_push(s, v_adj, wt[v_adj] + h);
+			}
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * @brief Encontra o caminho mais curto entre os vértices src e dst no grafo g.
+ * @details Implementa o algoritmo de Dijkstra fonte-destino,
+ *	recorrendo a uma fila prioritária implementada por acervo 4-ário
+ *	(ver dheap.h), ou por outra fila com cópias e remoção preguiçosa
+ *	(acervo 4-ário sem índice, acervo radix ou fila de baldes), conforme a
+ *	fila escolhida em sp_scratch_init().
+ *	Inicialmente, o vértice de origem é inserido na fila, para ser
+ *	retirado na primeira iteração do ciclo principal, sendo inseridos
+ *	agora na fila apenas vértices adjacentes à origem e assim em diante.
+ *
+ *	Se for dada uma tabela de marcos, a pesquisa é A*: a prioridade de cada
+ *	vértice é a sua distância à origem mais o limite inferior ALT da
+ *	distância ao destino. Como este limite é consistente, continua a ser
+ *	válido parar quando o destino sai da fila. Vértices que os marcos
+ *	mostram não alcançar o destino nem chegam a entrar na fila.
+ *
+ *	Se for dado um orçamento e este se esgotar, a pesquisa é abandonada:
+ *	budget->exceeded fica verdadeiro e st[dst] a -1.
+ *
+ * @param s Tabelas de trabalho da pesquisa (ver sp_scratch_init()).
+ * @param g Grafo a procurar.
+ * @param src Índice do vértice de origem.
+ * @param dst Índice do vértice de destino.
+ * @param st Árvore de caminhos.
+ * @param max_weight Peso máximo de arestas a considerar.
+ * @param lm Tabela de marcos para A*, ou NULL para Dijkstra. Só pode ser
+ *	usada com um destino (dst >= 0).
+ * @param budget Orçamento da pesquisa, ou NULL para não ter limites.
+ * @param cnt Contadores da pesquisa (postos a zero no início), ou NULL.
+ *
+ * @return wt Tabela de distâncias, que pertence a s.
+ */
+int *shortest_path(SpScratch *s, Graph *g, int src, int dst, int *st,
+		unsigned short max_weight, Landmarks *lm, Budget *budget, Counters *cnt)
+{
+	int v; /* Indíce de um vértice */
+	Counters none; /* Contadores descartados, se cnt for NULL. */
+	int *wt; /* Tabela de distâncias (s->wt). */
+	int pri = 0; /* Chave da origem na fila. */
+
+	if (cnt == NULL) {
+		cnt = &none;
+	}
+	memset(cnt, 0, sizeof(Counters));
+
+	/* Crescer as tabelas de trabalho para o tamanho corrente. */
+	sp_scratch_grow(s, g_get_size(g));
+	wt = s->wt;
+
+	/* Inicializar árvore de caminho e array de distâncias. */
+	for (v = 0; v < g_get_size(g); v++) {
+		st[v] = -1;
+		wt[v] = MAX_WT;
+	}
+
+	if (lm != NULL) {
+		/* Os marcos mostram que origem e destino estão em componentes
+		 * diferentes: não há caminho. */
+		if ((pri = lm_bound(lm, src, dst)) == MAX_WT) {
+			return wt;
+		}
+	}
+
+	/* Inicializar a fila apenas com o vértice de origem */
+	cnt->inserts++;
+	wt[src] = 0;
+	if (s->queue != SP_QUEUE_HEAP) {
+		switch (s->queue) {
+		case SP_QUEUE_RADIX:
+			rh_clear(s->radix);
+			break;
+		case SP_QUEUE_BUCKET:
+			/* Uma aresta sobe a chave no máximo do seu peso e, em A*,
+			 * outro tanto do limite (os limites ALT são consistentes). */
+			bq_clear(s->bucket, lm == NULL ? max_weight : 2 * max_weight);
+			break;
+		default:
+			lh_clear(s->lazy);
+		}
+		memset(s->done, 0, (g_get_size(g) + 7) / 8);
+		q_push(s, src, pri);
+		sp_run_lazy(s, g, dst, wt, st, max_weight, lm, budget, cnt);
+	}
+	else {
+		dh_clear(s->heap);
+		dh_insert(s->heap, src, pri);
+		sp_run(s, g, -1, dst, wt, st, max_weight, lm, budget, cnt);
+	}
+	if (budget != NULL && budget->exceeded) {
+		st[dst] = -1;
+	}
 
 	return wt;
 }
 
+/**
+ * @brief Árvore de caminhos mais curtos guardada numa TreeCache.
+ * @details key, src, max_weight: grafo (tamanho de palavra), origem e peso
+ *	máximo de arestas da pesquisa que a criou
+ *	n: número de vértices do grafo
+ *	wt, st: distâncias e árvore de caminhos
+ *	queue, count: vértices na fila, pela ordem do vetor da heap
+ *	queued: mapa de bits dos vértices em queue
+ *	last: vértice retirado da fila e ainda não percorrido, -1 se não houver
+ *	bytes: memória ocupada
+ *	prev, next: lista por ordem de utilização, da mais recente à mais antiga
+ *
+ *	Um vértice com distância conhecida que não está na fila já saiu dela:
+ *	a sua distância e caminho são definitivos. Com a fila vazia e last a
+ *	-1, a árvore está completa.
+ */
+typedef struct _SpTree {
+	int key;
+	int src;
+	unsigned short max_weight;
+	int n;
+	int *wt;
+	int *st;
+	unsigned short *queue;
+	int count;
+	unsigned char *queued;
+	int last;
+	unsigned long bytes;
+	struct _SpTree *prev, *next;
+} SpTree;
+
+/**
+ * @brief Cache LRU de árvores de caminhos mais curtos (ver sp_cached()).
+ * @details head, tail: árvores da mais para a menos recentemente usada
+ *	bytes, max_bytes: memória ocupada pelas árvores e o limite
+ */
+struct _TreeCache {
+	SpTree *head, *tail;
+	unsigned long bytes, max_bytes;
+};
+
+/**
+ * @brief Cria uma cache de árvores vazia.
+ *
+ * @param max_bytes Memória máxima ocupada pelas árvores.
+ * @return Cache.
+ */
+TreeCache *tc_init(unsigned long max_bytes)
+{
+	TreeCache *tc = (TreeCache *) emalloc(sizeof(TreeCache));
+
+	tc->head = tc->tail = NULL;
+	tc->bytes = 0;
+	tc->max_bytes = max_bytes;
+
+	return tc;
+}
+
+/**
+ * @brief Tira uma árvore da lista da cache.
+ */
+static void tc_unlink(TreeCache *tc, SpTree *t)
+{
+	if (t->prev != NULL) t->prev->next = t->next; else tc->head = t->next;
+	if (t->next != NULL) t->next->prev = t->prev; else tc->tail = t->prev;
+}
+
+/**
+ * @brief Põe uma árvore à cabeça da lista da cache (a mais recente).
+ */
+static void tc_push(TreeCache *tc, SpTree *t)
+{
+	t->prev = NULL;
+	t->next = tc->head;
+	if (tc->head != NULL) tc->head->prev = t; else tc->tail = t;
+	tc->head = t;
+}
+
+/**
+ * @brief Liberta uma árvore que já não está na lista.
+ */
+static void tc_free_tree(TreeCache *tc, SpTree *t)
+{
+	tc->bytes -= t->bytes;
+	free(t->wt);
+	free(t->st);
+	free(t->queue);
+	free(t->queued);
+	free(t);
+}
+
+/**
+ * @brief Liberta a cache e todas as suas árvores.
+ *
+ * @param tc Cache.
+ */
+void tc_free(TreeCache *tc)
+{
+	SpTree *t;
+
+	while ((t = tc->head) != NULL) {
+		tc_unlink(tc, t);
+		tc_free_tree(tc, t);
+	}
+	free(tc);
+}
+
+/**
+ * @brief Guarda a fila das tabelas de trabalho na árvore, tal como está.
+ */
+static void tc_save(SpTree *t, SpScratch *s, int last)
+{
+	int i, v;
+
+	memset(t->queued, 0, (t->n + 7) / 8);
+	t->count = dh_count(s->heap);
+	for (i = 0; i < t->count; i++) {
+		v = dh_value(s->heap, i);
+		t->queue[i] = v;
+		t->queued[v / 8] |= 1 << (v % 8);
+	}
+	t->last = last;
+}
+
+/**
+ * @brief Refaz nas tabelas de trabalho a fila guardada na árvore.
+ */
+static void tc_restore(SpTree *t, SpScratch *s)
+{
+	int i, v;
+
+	dh_clear(s->heap);
+	for (i = 0; i < t->count; i++) {
+		v = t->queue[i];
+		dh_append(s->heap, v, t->wt[v]);
+	}
+}
+
+/**
+ * @brief Cria uma árvore nova, só com a origem na fila, libertando as
+ *	árvores menos recentes até caber no limite da cache.
+ *
+ * @return Árvore, ou NULL se uma árvore deste grafo não cabe na cache.
+ */
+static SpTree *tc_new(TreeCache *tc, int key, int src, unsigned short max_weight, int n)
+{
+	SpTree *t;
+	unsigned long bytes = sizeof(SpTree) + n * (2 * sizeof(int)
+		+ sizeof(unsigned short)) + (n + 7) / 8;
+	int v;
+
+	if (bytes > tc->max_bytes) {
+		return NULL;
+	}
+	while (tc->bytes + bytes > tc->max_bytes) {
+		t = tc->tail;
+		tc_unlink(tc, t);
+		tc_free_tree(tc, t);
+	}
+
+	t = (SpTree *) emalloc(sizeof(SpTree));
+	t->key = key;
+	t->src = src;
+	t->max_weight = max_weight;
+	t->n = n;
+	t->wt = (int *) emalloc(n * sizeof(int));
+	t->st = (int *) emalloc(n * sizeof(int));
+	t->queue = (unsigned short *) emalloc(n * sizeof(unsigned short));
+	t->queued = (unsigned char *) emalloc((n + 7) / 8);
+	t->bytes = bytes;
+	tc->bytes += bytes;
+
+	for (v = 0; v < n; v++) {
+		t->st[v] = -1;
+		t->wt[v] = MAX_WT;
+	}
+	t->wt[src] = 0;
+	t->queue[0] = src;
+	t->count = 1;
+	memset(t->queued, 0, (n + 7) / 8);
+	t->queued[src / 8] |= 1 << (src % 8);
+	t->last = -1;
+
+	return t;
+}
+
+/**
+ * @brief Dijkstra simples (sem marcos) com uma cache de árvores de
+ *	caminhos mais curtos, por grafo, origem e peso máximo.
+ * @details Cada pesquisa é feita diretamente numa árvore da cache e
+ *	guarda no fim o estado da fila. Um problema seguinte com a mesma origem
+ *	é respondido sem pesquisa se o destino já saiu da fila; senão a
+ *	pesquisa continua onde parou, com a fila refeita exatamente como
+ *	estava. Como Dijkstra simples só usa o destino para parar, o resultado
+ *	(incluindo os desempates) é o mesmo de shortest_path() desde a origem.
+ *
+ *	As árvores continuam válidas se o grafo for reconstruído com mais
+ *	arestas ou recriado, pois as arestas até ao peso máximo e a ordem das
+ *	listas de adjacências não mudam (ver ensure_edges() em file.c).
+ *
+ *	Se o orçamento se esgotar, st[dst] não é posto a -1 (a árvore continua
+ *	a ser usada): é budget->exceeded que diz que não há resposta.
+ *
+ *	A fila guardada é sempre a indexada, seja qual for a de s.
+ *
+ * @param tc Cache de árvores.
+ * @param s Tabelas de trabalho.
+ * @param g Grafo a procurar.
+ * @param key Identificação do grafo na cache (o tamanho de palavra).
+ * @param src Índice do vértice de origem.
+ * @param dst Índice do vértice de destino.
+ * @param st Entra com uma árvore de caminhos de quem chama, usada se a
+ *	árvore deste grafo não couber na cache; sai com a árvore de caminhos
+ *	(em geral, a da cache).
+ * @param max_weight Peso máximo de arestas a considerar.
+ * @param budget Orçamento da pesquisa, ou NULL para não ter limites.
+ * @param cnt Contadores da pesquisa (postos a zero no início), ou NULL.
+ *
+ * @return Tabela de distâncias, que pertence à cache ou a s. Tanto esta
+ *	como *st só são válidas até à próxima pesquisa com tc ou s.
+ */
+int *sp_cached(TreeCache *tc, SpScratch *s, Graph *g, int key, int src, int dst,
+		int **st, unsigned short max_weight, Budget *budget, Counters *cnt)
+{
+	SpTree *t;
+	int n = g_get_size(g);
+	int last;
+	bool fresh = false; /* Árvore criada agora. */
+	Counters none;
+
+	for (t = tc->head; t != NULL; t = t->next) {
+		if (t->key == key && t->src == src && t->max_weight == max_weight
+				&& t->n == n) {
+			break;
+		}
+	}
+
+	if (t == NULL) {
+		if ((t = tc_new(tc, key, src, max_weight, n)) == NULL) {
+			/* Não cabe: pesquisar sem cache, na tabela de quem chama. */
+			return shortest_path(s, g, src, dst, *st, max_weight, NULL, budget, cnt);
+		}
+		fresh = true;
+	}
+	else {
+		tc_unlink(tc, t);
+	}
+	tc_push(tc, t);
+
+	if (cnt == NULL) {
+		cnt = &none;
+	}
+	memset(cnt, 0, sizeof(Counters));
+	*st = t->st;
+	if (fresh) {
+		/* A origem acabou de entrar na fila. */
+		cnt->inserts++;
+	}
+
+	/* O destino já saiu da fila, ou a árvore está completa. */
+	if (dst == t->last || (t->wt[dst] != MAX_WT && !(t->queued[dst / 8] & (1 << (dst % 8))))
+			|| (t->count == 0 && t->last == -1)) {
+		return t->wt;
+	}
+
+	sp_scratch_grow(s, n);
+	tc_restore(t, s);
+	last = sp_run(s, g, t->last, dst, t->wt, t->st, max_weight, NULL, budget, cnt);
+	tc_save(t, s, last);
+
+	return t->wt;
+}
+
+/**
+ * @brief Nome de uma fila de shortest_path() (ver --queue).
+ *
+ * @param queue Fila (SP_QUEUE_*).
+ * @return Nome.
+ */
+const char *sp_queue_name(int queue)
+{
+	return queue_names[queue];
+}
+
+/**
+ * @brief Procura uma fila de shortest_path() pelo nome.
+ *
+ * @param name Nome (ver sp_queue_name()).
+ * @return Fila (SP_QUEUE_*), ou -1 se não houver nenhuma com esse nome.
+ */
+int sp_queue_find(const char *name)
+{
+	int i;
+
+	for (i = 0; i < SP_NUM_QUEUES; i++) {
+		if (strcmp(name, queue_names[i]) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @brief Verifica se uma pesquisa esgotou o seu orçamento.
+ * @details O relógio só é lido a cada 64 vértices, pois é bem mais caro
+ *	que fixar um vértice.
+ *
+ * @param budget Orçamento da pesquisa.
+ * @param settled Número de vértices fixados até agora.
+ * @return Verdadeiro (e budget->exceeded) se o orçamento se esgotou.
+ */
+bool budget_spent(Budget *budget, long settled)
+{
+	if ((budget->max_settled > 0 && settled > budget->max_settled)
+			|| (budget->deadline > 0 && settled % 64 == 0
+				&& mono_time() > budget->deadline)) {
+		budget->exceeded = true;
+	}
+
+	return budget->exceeded;
+}
+
 /**
  * @brief Averigua entre dois items qual tem menos prioridade.
  * @details Se s1 tem menos prioridade que s2, é porque
- * s1 tem maior distância à origem considerada do grafo.
+ * s1 tem maior distância à origem considerada do grafo (em A*, maior
+ * estimativa do comprimento do caminho que passa por s1).
  *
- * @param s1 Item (ponteiro para inteiro) 1
- * @param s2 Item (ponteiro para inteiro) 2
+ * @param s1 Item (ponteiro para SpItem) 1
+ * @param s2 Item (ponteiro para SpItem) 2
  *
  * @return booleano: 1 (true) se s1 tiver menos prioridade que s2,
  *	0 se s1 tiver maior ou igual prioridade a s2.
  */
 bool d_less_pri(Item s1, Item s2)
 {
-	return wt[*((int *) s1)] > wt[*((int *) s2)];
+	return ((SpItem *) s1)->pri > ((SpItem *) s2)->pri;
 }
 
 /**
@@ -139,11 +780,11 @@ bool d_less_pri(Item s1, Item s2)
  *	mapeia indíces do grafo para indíces da fila. Assim, existe uma
  *	relação 1:1, evitando colisões.
  *
- * @param a Item (ponteiro para inteiro) que está na fila.
+ * @param a Item (ponteiro para SpItem) que está na fila.
  *
  * @return Índice do vértice no grafo correspondente a este Item.
  */
 unsigned short d_hash(Item a)
 {
-	return *((int *) a);
+	return ((SpItem *) a)->index;
 }
@@ -15,7 +15,80 @@
 
 #define MAX_WT 10000000
 
-int *shortest_path(Graph *g, int src, int dst, int *st, unsigned short max_weight);
+/* Filas prioritárias de shortest_path() (ver sp_scratch_init()). */
+#define SP_QUEUE_HEAP 0 /* Acervo indexado, com redução de chaves. */
+#define SP_QUEUE_LAZY 1 /* Acervo com cópias e remoção preguiçosa. */
+#define SP_QUEUE_RADIX 2 /* Acervo radix, com cópias. */
+#define SP_QUEUE_BUCKET 3 /* Fila de baldes (Dial), com cópias. */
+#define SP_NUM_QUEUES 4
+
+/**
+ * @brief Orçamento de uma pesquisa.
+ * @details max_settled: número máximo de vértices fixados, 0 sem limite
+ *	deadline: instante (de mono_time()) até ao qual a pesquisa pode correr,
+ *	0 sem limite
+ *	exceeded: escrito pela pesquisa: verdadeiro se o orçamento se esgotou
+ *	antes de encontrar o destino
+ */
+typedef struct _Budget {
+	long max_settled;
+	double deadline;
+	bool exceeded;
+} Budget;
+
+/**
+ * @brief Contadores de uma pesquisa.
+ * @details settled: vértices fixados (cuja lista de adjacências foi
+ *	percorrida)
+ *	scanned: arestas percorridas
+ *	filtered: arestas ignoradas por terem peso acima do máximo
+ *	inserts, decreases, pops: inserções, reduções de distância e remoções
+ *	na fila prioritária (nas filas com cópias, cada redução insere uma
+ *	cópia)
+ *	stale: remoções descartadas por o vértice já estar fixado (só nas
+ *	filas com cópias)
+ */
+typedef struct _Counters {
+	long settled;
+	long scanned;
+	long filtered;
+	long inserts;
+	long decreases;
+	long pops;
+	long stale;
+} Counters;
+
+/**
+ * @brief Item das filas prioritárias genéricas (heap.c) das hierarquias de
+ *	contração.
+ * @details pri: chave comparada por d_less_pri() (menor sai primeiro)
+ *	index: índice do vértice, devolvido por d_hash()
+ *
+ *	A chave vive no próprio item, para que a comparação não dependa de
+ *	tabelas globais e várias pesquisas possam correr ao mesmo tempo.
+ */
+typedef struct _SpItem {
+	int pri;
+	int index;
+} SpItem;
+
+/* Tabelas de trabalho de shortest_path(), uma por quem pesquisa. */
+typedef struct _SpScratch SpScratch;
+
+/* Cache de árvores de caminhos mais curtos, ver sp_cached(). */
+typedef struct _TreeCache TreeCache;
+
+SpScratch *sp_scratch_init(int queue);
+void sp_scratch_free(SpScratch *s);
+int *shortest_path(SpScratch *s, Graph *g, int src, int dst, int *st,
+		unsigned short max_weight, Landmarks *lm, Budget *budget, Counters *cnt);
+TreeCache *tc_init(unsigned long max_bytes);
+void tc_free(TreeCache *tc);
+int *sp_cached(TreeCache *tc, SpScratch *s, Graph *g, int key, int src, int dst,
+		int **st, unsigned short max_weight, Budget *budget, Counters *cnt);
+const char *sp_queue_name(int queue);
+int sp_queue_find(const char *name);
+bool budget_spent(Budget *budget, long settled);
 bool d_less_pri(Item s1, Item s2);
 unsigned short d_hash(Item a);
 
@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 #include "file.h"
 #include "utils.h"
@@ -18,181 +19,1446 @@
 #include "graph.h"
 #include "word.h"
 #include "dijkstra.h"
+#include "landmark.h"
+#include "ch.h"
+#include "options.h"
+#include "stats.h"
+#include "pipeline.h"
+#include "build.h"
+#include "result.h"
+#include "outbuf.h"
+#include "binio.h"
+#include "reorder.h"
 
+/* Identificação do ficheiro de tabelas de marcos. */
+#define LM_MAGIC "WMLM1"
+
+
+/* Dicionário lido por read_dic(), que fica aberto: os grafos de cada
+ * tamanho de palavra só são criados, com uma nova leitura do dicionário, no
+ * primeiro problema desse tamanho (ver load_graph()). */
+static FILE *dic = NULL;
+static int dic_count[MAX_WORD_SIZE];
+/* Checksum das palavras de cada tamanho, pela ordem do dicionário: os
+ * índices dos vértices dependem só delas (ver load_results()). */
+static unsigned long dic_sum[MAX_WORD_SIZE];
+
+/* Maior número de permutações dos problemas do .pal de cada tamanho de
+ * palavra, 0 se desconhecido (modo servidor): as arestas de um grafo são
+ * logo construídas para esse limiar, em vez de reconstruídas a cada
+ * problema com mais permutações que os anteriores (ver prepare()). */
+static unsigned short pal_perm[MAX_WORD_SIZE];
+
+/* Tabelas de marcos de grafos já libertados por free_graph(), no formato de
+ * save_landmarks(), à espera de serem guardadas; NULL se não houver. */
+static FILE *lm_spill = NULL;
 
 /**
- * @brief Encontrar número máximo de permutações para cada tamanho de palavra.
+ * @brief Ler o dicionário para saber quantas palavras tem de cada tamanho.
+ * @details Os grafos não são construídos aqui: cada um é criado (vértices)
+ *	e ligado (arestas) apenas quando chega o primeiro problema que precisa
+ *	dele, pelo que os tamanhos que nenhum problema usa nunca custam nada.
+ *	O ficheiro tem de ficar aberto até ao fim da resolução.
  *
- * @param fpal Ficheiro .pal de problemas.
+ * @param fdic Ficheiro de dicionário.
  *
- * @return max_perms Tabela de unsigned shorts, indexada pelos tamanhos
- *	de palavra existentes no .pal e cujos valores são o número máximo de permutações
- *	para esse tamanho de palavra, zero se esse tamanho não existir.
+ * @return graphs Tabela de grafos, indexada pelo tamanho de palavras
+ *	que contém; ou seja, graph[2] corresponde o grafo que contém vértices
+ *	(palavras) de tamanho dois. Começa com todos os grafos a NULL.
  */
-unsigned short *find_max_perms(FILE *fpal)
+Graph **read_dic(FILE *fdic)
 {
-	unsigned short *max_perms;
 	char buffer[MAX_WORD_SIZE];
-	char word1[MAX_WORD_SIZE], word2[MAX_WORD_SIZE];
-	unsigned short perm;
-	size_t size;
+	Graph **graphs;
+	int i;
 
-	/* Inicializar max_perms a zero. */
-	max_perms = (unsigned short *) ecalloc(MAX_WORD_SIZE, sizeof(unsigned short));
+	for (i = 0; i < MAX_WORD_SIZE; i++) {
+		dic_count[i] = 0;
+		dic_sum[i] = 0;
+	}
+
+	/* Contar os vértices de cada tamanho de palavra, para alocar cada
+	 * grafo de uma só vez quando for preciso. */
+	while (fscanf(fdic, "%63s", buffer) == 1) {
+		i = strlen(buffer);
+		dic_count[i]++;
+		dic_sum[i] = dic_sum[i] * 31 + w_hash(buffer);
+	}
+	dic = fdic;
 
-	/* Ler cada linha do .pal */
-	while (fgets(buffer, MAX_WORD_SIZE, fpal) != NULL) {
-		sscanf(buffer, "%s %s %hu", word1, word2, &perm);
-		size = strlen(word1);
-		/* Guardar número máximo de permutações */
-		if (max_perms[size] < perm && w_diff(word1, word2, 1) > 1) {
-			max_perms[size] = perm;
+	/* Os índices dos vértices são unsigned short: um dicionário maior
+	 * não cabe no grafo. */
+	for (i = 0; i < MAX_WORD_SIZE; i++) {
+		if (dic_count[i] > MAX_VERTICES) {
+			fprintf(stderr, "Erro: %d palavras de tamanho %d, o máximo é %d.\n",
+				dic_count[i], i, MAX_VERTICES);
+			exit(EXIT_FAILURE);
 		}
 	}
 
-	return max_perms;
+	graphs = (Graph **) emalloc(MAX_WORD_SIZE * sizeof(Graph *));
+	for (i = 0; i < MAX_WORD_SIZE; i++) {
+		graphs[i] = NULL;
+	}
+
+	return graphs;
 }
 
 /**
- * @brief Construir tabela de grafos com vértices sendo palavras vindas
- *	do dicionário.
+ * @brief Cria o grafo de um tamanho de palavra, se ainda não existir, com
+ *	as palavras desse tamanho por ordem do dicionário e ainda sem arestas.
  *
- * @param fdic Ficheiro de dicionário.
- * @param max_perms Tabela com número máximo de permutações por tamanho,
- *	vinda de find_max_perms()
- *
- * @return graphs Tabela de grafos, indexada pelo tamanho de palavras
- *	que contém; ou seja, graph[2] corresponde o grafo que contém vértices
- *	(palavras) de tamanho dois. Nos tamanhos não existentes, graph[i] é NULL.
+ * @param graphs Tabela de grafos.
+ * @param size Tamanho de palavra.
+ * @return Grafo, ou NULL se o dicionário não tiver palavras desse tamanho.
  */
-Graph **read_dic(FILE *fdic, unsigned short *max_perms)
+static Graph *load_graph(Graph **graphs, int size)
 {
 	char buffer[MAX_WORD_SIZE];
-	int num_words[MAX_WORD_SIZE] = {0};
-	Graph **graphs;
-	size_t size;
-	int i;
+	Graph *g;
 
-	/* Ler o dicionário uma primeira vez para saber quantos vértices
-	 * de cada tamanho de palavra alocar, para construir os grafos. */
-	while (fscanf(fdic, "%s", buffer) == 1) {
-		i = strlen(buffer);
-		if (max_perms[i] != 0) {
-			num_words[strlen(buffer)]++;
+	if (graphs[size] != NULL || dic_count[size] == 0) {
+		return graphs[size];
+	}
+
+	st_begin("read_dic:insert");
+	g = g_init(dic_count[size], 0);
+	rewind(dic);
+	while (fscanf(dic, "%63s", buffer) == 1) {
+		if (strlen(buffer) == (size_t) size) {
+			g_insert(g, w_new(buffer));
 		}
 	}
+	st_end();
 
-	rewind(fdic);
+	graphs[size] = g;
+	return g;
+}
 
-	/* Array de MAX_WORD_SIZE grafos, em que apenas alocamos
-	 * grafos cujos índices no array correspondem a tamanhos de palavra
-	 * que precisamos (os outros ficam a NULL) */
-	graphs = (Graph **) emalloc(MAX_WORD_SIZE * sizeof(Graph *));
-	for (i = 0; i < MAX_WORD_SIZE; i++) {
-		if (max_perms[i] != 0) {
-			graphs[i] = g_init(num_words[i], max_perms[i]);
+/**
+ * @brief Copia bytes de um ficheiro para outro.
+ *
+ * @param from Ficheiro de onde ler, a partir da posição corrente.
+ * @param to Ficheiro onde escrever.
+ * @param n Número de bytes a copiar, ou -1 para copiar até ao fim.
+ */
+static void copy_bytes(FILE *from, FILE *to, long n)
+{
+	char buffer[BUFSIZ];
+	size_t chunk, got;
+
+	while (n != 0) {
+		chunk = n < 0 || n > (long) sizeof(buffer) ? sizeof(buffer) : (size_t) n;
+		if ((got = fread(buffer, 1, chunk, from)) == 0) {
+			break;
 		}
-		else {
-			graphs[i] = NULL;
+		fwrite(buffer, 1, got, to);
+		if (n > 0) {
+			n -= (long) got;
+		}
+	}
+}
+
+/**
+ * @brief Liberta o grafo de um tamanho de palavra, com os marcos e as
+ *	hierarquias; um problema seguinte desse tamanho volta a criá-lo.
+ * @details Se as tabelas de marcos forem para guardar (--alt-file), são
+ *	primeiro escritas em lm_spill, para save_landmarks() as juntar ao
+ *	ficheiro no fim.
+ *
+ * @param graphs Tabela de grafos.
+ * @param size Tamanho de palavra.
+ */
+static void free_graph(Graph **graphs, int size)
+{
+	Graph *g = graphs[size];
+
+	if (g == NULL) {
+		return;
+	}
+
+	if (options.alt_file != NULL && options.alt_landmarks > 0
+			&& g_get_landmarks(g) != NULL) {
+		if (lm_spill == NULL && (lm_spill = tmpfile()) == NULL) {
+			fprintf(stderr, "Erro: impossível criar ficheiro temporário.\n");
+			exit(EXIT_FAILURE);
 		}
+		fwrite(&size, sizeof(int), 1, lm_spill);
+		lm_write(lm_spill, g, w_hash);
+	}
+
+	st_begin("free_graph");
+	lm_free(g_get_landmarks(g));
+	ch_free(g_get_hierarchies(g));
+	g_free(g, w_free);
+	graphs[size] = NULL;
+	st_end();
+}
+
+/**
+ * @brief Obter a tabela de marcos de um grafo para um limiar de peso.
+ * @details Se o grafo ainda não tiver uma tabela que sirva o limiar,
+ *	esta é construída com options.alt_landmarks marcos e guardada no grafo,
+ *	para ser reutilizada pelos problemas seguintes.
+ *
+ * @param g Grafo do tamanho de palavra pretendido.
+ * @param max_weight Peso máximo de arestas da pesquisa.
+ * @return Tabela de marcos.
+ */
+Landmarks *find_landmarks(Graph *g, unsigned short max_weight)
+{
+	Landmarks *lm = lm_select(g_get_landmarks(g), max_weight);
+
+	if (lm == NULL) {
+		st_begin("lm_build");
+		lm = lm_build(g, max_weight, options.alt_landmarks);
+		st_end();
+		g_set_landmarks(g, lm_add(g_get_landmarks(g), lm));
+	}
+
+	return lm;
+}
+
+/**
+ * @brief Obter a hierarquia de contração de um grafo para um limiar de peso.
+ * @details Construída no primeiro problema que a pede e guardada no grafo.
+ *
+ * @param g Grafo do tamanho de palavra pretendido.
+ * @param max_weight Peso máximo de arestas da pesquisa.
+ * @return Hierarquia.
+ */
+Hierarchy *find_hierarchy(Graph *g, unsigned short max_weight)
+{
+	Hierarchy *ch = ch_select(g_get_hierarchies(g), max_weight);
+
+	if (ch == NULL) {
+		st_begin("ch_build");
+		ch = ch_build(g, max_weight);
+		st_end();
+		g_set_hierarchies(g, ch_add(g_get_hierarchies(g), ch));
+	}
+
+	return ch;
+}
+
+/**
+ * @brief Ler tabelas de marcos guardadas por save_landmarks().
+ * @details Se o ficheiro não existir não há nada a ler. Tabelas de grafos
+ *	que não foram construídos nesta execução, ou que não correspondem aos
+ *	grafos atuais (dicionário diferente), são ignoradas.
+ *
+ * @param name Nome do ficheiro de tabelas.
+ * @param graphs Tabela de grafos.
+ */
+void load_landmarks(const char *name, Graph **graphs)
+{
+	FILE *f;
+	char magic[sizeof(LM_MAGIC)];
+	int size;
+
+	if ((f = fopen(name, "rb")) == NULL) {
+		return;
+	}
+
+	if (fread(magic, 1, sizeof(magic), f) != sizeof(magic)
+			|| memcmp(magic, LM_MAGIC, sizeof(magic)) != 0) {
+		fprintf(stderr, "Aviso: %s não é um ficheiro de marcos.\n", name);
+		fclose(f);
+		return;
 	}
 
-	/* Reler o dicionário para construir os grafos. */
-	while (fscanf(fdic, "%s", buffer) == 1) {
-		size = strlen(buffer);
-		/* Ignorar palavras cujos tamanhos já sabemos que não precisamos. */
-		if (max_perms[size] != 0) {
-			g_insert(graphs[size], w_new(buffer));
+	/* Cada bloco começa pelo tamanho de palavra do grafo. */
+	while (fread(&size, sizeof(int), 1, f) == 1) {
+		if (size < 0 || size >= MAX_WORD_SIZE) {
+			fprintf(stderr, "Aviso: %s está corrompido.\n", name);
+			break;
+		}
+		/* As tabelas só podem ser verificadas com as palavras do grafo.
+		 * Sem grafo deste tamanho, lm_read() descarta-as. */
+		if (lm_read(f, load_graph(graphs, size), w_hash) < 0) {
+			fprintf(stderr, "Aviso: %s está corrompido.\n", name);
+			break;
 		}
 	}
 
-	/* Construir as arestas entre cada palavra, com pesos até o quadrado
-	 * do número máximo de permutações para cada tamanho. */
+	fclose(f);
+}
+
+/**
+ * @brief Guardar as tabelas de marcos de todos os grafos num ficheiro.
+ * @details Inclui as dos grafos já libertados por free_graph().
+ *
+ * @param name Nome do ficheiro de tabelas.
+ * @param graphs Tabela de grafos.
+ */
+void save_landmarks(const char *name, Graph **graphs)
+{
+	FILE *f = efopen(name, "wb");
+	int i;
+
+	fwrite(LM_MAGIC, 1, sizeof(LM_MAGIC), f);
 	for (i = 0; i < MAX_WORD_SIZE; i++) {
-		if (max_perms[i] != 0) {
-			g_make_edges(graphs[i], w_diff);
+		if (graphs[i] != NULL && g_get_landmarks(graphs[i]) != NULL) {
+			fwrite(&i, sizeof(int), 1, f);
+			lm_write(f, graphs[i], w_hash);
 		}
 	}
+	/* Tabelas dos grafos que já foram libertados (--by-length). */
+	if (lm_spill != NULL) {
+		rewind(lm_spill);
+		copy_bytes(lm_spill, f, -1);
+		fclose(lm_spill);
+		lm_spill = NULL;
+	}
 
-	return graphs;
+	fclose(f);
 }
 
 /**
- * @brief Encontrar caminho mais curto entre cada duas palavras do ficheiro
- *	de problemas.
+ * @brief Ler resultados de problemas guardados por save_results().
+ * @details Só são lidos os resultados dos tamanhos de palavra cujas
+ *	palavras são as mesmas do dicionário atual (ver rc_read()).
+ *
+ * @param name Nome do ficheiro de resultados.
+ */
+void load_results(const char *name)
+{
+	rc_read(name, dic_sum, dic_count);
+}
+
+/**
+ * @brief Guardar os resultados de todos os problemas resolvidos, incluindo
+ *	os lidos por load_results().
+ *
+ * @param name Nome do ficheiro de resultados.
+ */
+void save_results(const char *name)
+{
+	rc_write(name, dic_sum);
+}
+
+/**
+ * @brief Renumera os vértices de um grafo acabado de construir
+ *	(--renumber).
+ * @details A ordem é calculada na primeira construção das arestas e fica
+ *	para as seguintes, que só repõem a ordem das listas (ver g_permute()):
+ *	os índices dos vértices não mudam enquanto o grafo existir.
+ *
+ * @param g Grafo com as arestas construídas.
+ */
+static void renumber(Graph *g)
+{
+	unsigned short *order;
+
+	if (options.renumber == RO_NONE) {
+		return;
+	}
+
+	st_begin("renumber");
+	if (!g_is_permuted(g)) {
+		order = ro_order(g, options.renumber);
+		g_permute(g, order);
+		lm_permute(g_get_landmarks(g), order);
+		free(order);
+	}
+	else {
+		g_permute(g, NULL);
+	}
+	st_end();
+}
+
+/**
+ * @brief Comprime as listas de adjacências de um grafo acabado de
+ *	construir (--packed-adj), depois de renumber().
+ *
+ * @param g Grafo com as arestas construídas.
+ */
+static void pack(Graph *g)
+{
+	if (!options.packed_adj) {
+		return;
+	}
+
+	st_begin("g_pack");
+	g_pack(g);
+	st_end();
+}
+
+/**
+ * @brief Garante que o grafo tem as arestas de um problema.
+ * @details Os grafos começam sem arestas e são (re)construídos quando chega
+ *	um problema com mais permutações do que o grafo tem. As tabelas de
+ *	marcos e hierarquias já construídas continuam válidas, pois as arestas
+ *	até ao limiar antigo não mudam, nem a ordem das listas de adjacências.
+ *
+ * @param g Grafo do tamanho de palavra do problema.
+ * @param size Tamanho de palavra.
+ * @param max_perm Número máximo de permutações do problema.
+ */
+static void ensure_edges(Graph *g, int size, unsigned short max_perm)
+{
+	double seconds;
+
+	if (g_get_max_weight(g) >= max_perm*max_perm) {
+		return;
+	}
+
+	st_begin("g_make_edges");
+	g_clear_edges(g, max_perm);
+	/* Com --build-threads, as linhas do grafo são repartidas pelos fios. */
+	bd_make_edges(&g, 1, options.build_threads, w_diff, &seconds);
+	st_end();
+	renumber(g);
+	pack(g);
+	/* A memória do grafo é a da forma final das listas. */
+	st_graph(size, g, seconds);
+}
+
+/**
+ * @brief Cria o estado de quem resolve problemas.
+ *
+ * @param lock Função que obtém o acesso a um grafo, ou NULL se só houver um
+ *	fio de execução (ver Solver).
+ * @param unlock Função que liberta o acesso obtido por lock, ou NULL.
+ * @return Estado, com as tabelas de trabalho ainda vazias.
+ */
+Solver *so_init(void (*lock)(int size, bool exclusive),
+		void (*unlock)(int size, bool exclusive))
+{
+	Solver *so = (Solver *) emalloc(sizeof(Solver));
+
+	so->sp = sp_scratch_init(options.queue);
+	so->ch = ch_scratch_init();
+	so->tc = NULL;
+	if (options.tree_cache > 0) {
+		so->tc = tc_init((unsigned long) options.tree_cache << 20);
+	}
+	so->path = NULL;
+	so->stack = NULL;
+	so->size = 0;
+	so->out = ob_init();
+	so->lock = lock;
+	so->unlock = unlock;
+
+	return so;
+}
+
+/**
+ * @brief Liberta o estado de quem resolve problemas.
+ *
+ * @param so Estado.
+ */
+void so_free(Solver *so)
+{
+	sp_scratch_free(so->sp);
+	ch_scratch_free(so->ch);
+	if (so->tc != NULL) {
+		tc_free(so->tc);
+	}
+	free(so->path);
+	free(so->stack);
+	ob_free(so->out);
+	free(so);
+}
+
+/**
+ * @brief Obtém o acesso a um grafo (ou às estatísticas, com size 0).
+ */
+static void so_lock(Solver *so, int size, bool exclusive)
+{
+	if (so->lock != NULL) {
+		so->lock(size, exclusive);
+	}
+}
+
+/**
+ * @brief Liberta o acesso obtido por so_lock().
+ */
+static void so_unlock(Solver *so, int size, bool exclusive)
+{
+	if (so->unlock != NULL) {
+		so->unlock(size, exclusive);
+	}
+}
+
+/**
+ * @brief Regista as estatísticas de um problema (ver st_query()).
+ */
+static void so_query(Solver *so, const char *word1, const char *word2, int max_perm,
+		int cost, const Counters *cnt, double seconds)
+{
+	so_lock(so, 0, true);
+	st_query(word1, word2, max_perm, cost, cnt, seconds);
+	so_unlock(so, 0, true);
+}
+
+/**
+ * @brief Verifica se o grafo de um tamanho de palavra já tem tudo o que um
+ *	problema precisa: os vértices e, se edges, as arestas até ao limiar e
+ *	o pré-processamento pedido.
  *
- * @param fpal Ficheiro .pal de problemas.
- * @param fpath Ficheiro .path de saída com os caminhos e pesos correspondentes.
  * @param graphs Tabela de grafos.
+ * @param size Tamanho de palavra.
+ * @param max_perm Número máximo de permutações do problema.
+ * @param edges Falso se bastarem os vértices (para procurar as palavras).
+ * @return Verdadeiro se não for preciso chamar prepare().
  */
-void solve_pal(FILE *fpal, FILE *fpath, Graph **graphs)
+static bool prepared(Graph **graphs, int size, unsigned short max_perm, bool edges)
+{
+	Graph *g = graphs[size];
+	unsigned short max_weight = max_perm*max_perm;
+
+	if (g == NULL) {
+		return dic_count[size] == 0;
+	}
+	if (!edges) {
+		return true;
+	}
+	if (g_get_max_weight(g) < max_weight) {
+		return false;
+	}
+	if (options.ch) {
+		return ch_select(g_get_hierarchies(g), max_weight) != NULL;
+	}
+	if (options.alt_landmarks > 0) {
+		return lm_select(g_get_landmarks(g), max_weight) != NULL;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Constrói o que falta no grafo para um problema (ver prepared()).
+ * @details É a única parte da resolução que altera os grafos; tudo o resto
+ *	só os lê.
+ *
+ * @param graphs Tabela de grafos.
+ * @param size Tamanho de palavra.
+ * @param max_perm Número máximo de permutações do problema.
+ * @param edges Falso para criar apenas os vértices.
+ */
+static void prepare(Graph **graphs, int size, unsigned short max_perm, bool edges)
+{
+	Graph *g = load_graph(graphs, size);
+
+	if (g == NULL || !edges) {
+		return;
+	}
+	ensure_edges(g, size, max_perm > pal_perm[size] ? max_perm : pal_perm[size]);
+	if (options.ch) {
+		find_hierarchy(g, max_perm*max_perm);
+	}
+	else if (options.alt_landmarks > 0) {
+		find_landmarks(g, max_perm*max_perm);
+	}
+}
+
+/**
+ * @brief Obtém acesso partilhado a um grafo que tem o que um problema
+ *	precisa, construindo primeiro o que faltar com acesso exclusivo.
+ * @details O que prepare() constrói nunca é desfeito, pelo que basta
+ *	verificar uma vez depois de obter o acesso partilhado.
+ *
+ * @param so Estado de quem resolve.
+ * @param graphs Tabela de grafos.
+ * @param size Tamanho de palavra.
+ * @param max_perm Número máximo de permutações do problema.
+ * @param edges Falso se bastarem os vértices.
+ * @return Grafo (NULL se o dicionário não tiver palavras deste tamanho),
+ *	com acesso partilhado a libertar com so_unlock(so, size, false).
+ */
+static Graph *so_acquire(Solver *so, Graph **graphs, int size, unsigned short max_perm,
+		bool edges)
+{
+	so_lock(so, size, false);
+	if (!prepared(graphs, size, max_perm, edges)) {
+		so_unlock(so, size, false);
+		so_lock(so, size, true);
+		prepare(graphs, size, max_perm, edges);
+		so_unlock(so, size, true);
+		so_lock(so, size, false);
+	}
+
+	return graphs[size];
+}
+
+/**
+ * @brief Constrói, com acesso exclusivo, tudo o que um problema vai precisar
+ *	do grafo do seu tamanho (ver prepared()), para que a resolução só tenha
+ *	de o ler.
+ *
+ * @param so Estado de quem constrói.
+ * @param graphs Tabela de grafos.
+ * @param size Tamanho de palavra.
+ * @param max_perm Número máximo de permutações do problema.
+ */
+void so_prepare(Solver *so, Graph **graphs, int size, unsigned short max_perm)
+{
+	so_acquire(so, graphs, size, max_perm, true);
+	so_unlock(so, size, false);
+}
+
+/**
+ * @brief Liberta, com acesso exclusivo, o grafo de um tamanho de palavra
+ *	(ver free_graph()).
+ *
+ * @param so Estado de quem liberta.
+ * @param graphs Tabela de grafos.
+ * @param size Tamanho de palavra.
+ */
+void so_release(Solver *so, Graph **graphs, int size)
+{
+	so_lock(so, size, true);
+	free_graph(graphs, size);
+	so_unlock(so, size, true);
+}
+
+/**
+ * @brief Acrescenta a um buffer uma palavra do grafo, numa linha.
+ *
+ * @param b Buffer.
+ * @param g Grafo.
+ * @param v Índice do vértice.
+ * @param size Tamanho das palavras do grafo.
+ */
+static void put_word(OutBuf *b, Graph *g, int v, size_t size)
+{
+	ob_bytes(b, (char *) v_get_item(g_get_vertex(g, v)), size);
+	ob_char(b, '\n');
+}
+
+/**
+ * @brief Acrescenta a um buffer a primeira linha de um bloco: "word cost\n".
+ */
+static void put_head(OutBuf *b, const char *word, size_t size, int cost)
+{
+	ob_bytes(b, word, size);
+	ob_char(b, ' ');
+	ob_int(b, cost);
+	ob_char(b, '\n');
+}
+
+/**
+ * @brief Acrescenta a um buffer o bloco de um problema sem caminho
+ *	(custo negativo) ou trivial: "word1 cost\nword2\n\n", ou em binário
+ *	só o custo (ver binio.h).
+ *
+ * @param b Buffer.
+ * @param word1 Palavra de partida.
+ * @param cost Custo ou código de erro (const.h).
+ * @param word2 Palavra de chegada.
+ */
+static void put_block(OutBuf *b, const char *word1, int cost, const char *word2)
+{
+	if (options.path_binary) {
+		bin_put_result(b, cost, 0);
+		return;
+	}
+	put_head(b, word1, strlen(word1), cost);
+	ob_bytes(b, word2, strlen(word2));
+	ob_bytes(b, "\n\n", 2);
+}
+
+/**
+ * @brief Acrescenta ao buffer de so o bloco de um caminho encontrado.
+ * @details A árvore é percorrida do destino até à origem, guardando os
+ *	vértices em so->stack, que é depois lida ao contrário: em texto, as
+ *	palavras; em binário, os índices.
+ *
+ * @param so Estado de quem resolve (buffer e pilha de vértices).
+ * @param g Grafo do tamanho de palavra do problema.
+ * @param path Árvore de caminho, com -1 na origem.
+ * @param dst Índice do vértice de destino.
+ * @param size Tamanho de palavra.
+ * @param cost Custo do caminho.
+ */
+static void put_path(Solver *so, Graph *g, int *path, int dst, size_t size, int cost)
+{
+	int n = 0;
+	int v;
+
+	for (v = dst; v != -1; v = path[v]) {
+		so->stack[n++] = v;
+	}
+
+	if (options.path_binary) {
+		bin_put_result(so->out, cost, n);
+		while (n > 0) {
+			bin_put_vertex(so->out, g_get_orig(g, so->stack[--n]));
+		}
+		return;
+	}
+
+	/* Origem, com o custo, e depois o resto do caminho até ao destino. */
+	v = so->stack[--n];
+	put_head(so->out, (char *) v_get_item(g_get_vertex(g, v)), size, cost);
+	while (n > 0) {
+		put_word(so->out, g, so->stack[--n], size);
+	}
+	ob_char(so->out, '\n');
+}
+
+/**
+ * @brief Acrescenta ao buffer de so o bloco de um problema a partir do seu
+ *	resultado guardado (ver result.c), no sentido do problema.
+ *
+ * @param so Estado de quem resolve.
+ * @param g Grafo do tamanho de palavra do problema.
+ * @param r Resultado.
+ * @param src Índice original (ver g_get_orig()) do vértice de partida.
+ * @param word1 Palavra de partida.
+ * @param word2 Palavra de chegada.
+ */
+static void put_result(Solver *so, Graph *g, const Result *r, int src,
+		char *word1, char *word2)
+{
+	size_t size = strlen(word1);
+	int i;
+
+	if (rc_cost(r) < 0) {
+		put_block(so->out, word1, rc_cost(r), word2);
+		return;
+	}
+	if (options.path_binary) {
+		bin_put_result(so->out, rc_cost(r), rc_length(r));
+		for (i = 0; i < rc_length(r); i++) {
+			bin_put_vertex(so->out, rc_vertex(r, src, i));
+		}
+		return;
+	}
+
+	put_head(so->out, word1, size, rc_cost(r));
+	for (i = 1; i < rc_length(r); i++) {
+		put_word(so->out, g, g_get_index(g, rc_vertex(r, src, i)), size);
+	}
+	ob_char(so->out, '\n');
+}
+
+/**
+ * @brief Passa o caminho de uma árvore para a numeração original dos
+ *	vértices (ver g_permute()), para a cache de resultados.
+ * @details Só os vértices do caminho até dst são escritos, em so->stack,
+ *	que tem uma posição por vértice do grafo.
+ *
+ * @param so Estado de quem resolve.
+ * @param g Grafo renumerado.
+ * @param path Árvore de caminho, com -1 na origem.
+ * @param dst Índice do vértice de destino.
+ * @return Árvore com o caminho de dst, pela numeração original.
+ */
+static int *orig_tree(Solver *so, Graph *g, int *path, int dst)
+{
+	int v;
+
+	for (v = dst; v != -1; v = path[v]) {
+		so->stack[g_get_orig(g, v)] = path[v] == -1 ? -1 : g_get_orig(g, path[v]);
+	}
+
+	return so->stack;
+}
+
+/**
+ * @brief Escreve o bloco montado no buffer de so, de uma só vez.
+ */
+static void so_write(Solver *so, FILE *fpath)
+{
+	ob_write(so->out, fpath);
+}
+
+/**
+ * @brief Resolve um problema e escreve o seu bloco no ficheiro de saída.
+ * @details Com vários fios de execução, a pesquisa é feita com acesso
+ *	partilhado ao grafo; a construção do que falta (prepare()) com acesso
+ *	exclusivo.
+ *
+ * @param fpath Ficheiro de saída.
+ * @param graphs Tabela de grafos.
+ * @param word1 Palavra de partida.
+ * @param word2 Palavra de chegada.
+ * @param max_perm Número máximo de permutações por passo.
+ * @param batch_end Prazo do lote (de mono_time()), 0 se não houver.
+ * @param so Estado de quem resolve (tabelas de trabalho e árvore de caminho).
+ */
+void solve_problem(FILE *fpath, Graph **graphs, char *word1, char *word2,
+		unsigned short max_perm, double batch_end, Solver *so)
 {
 	Graph *g; /* Grafo do tamanho de palavra pretendido. */
-	char word1[MAX_WORD_SIZE], word2[MAX_WORD_SIZE];
-	unsigned short max_perm;
+	size_t size = strlen(word1);
 	int src; /* Indíce do vértice de origem do grafo. */
 	int dst; /* Indíce do vértice de destino do grafo. */
-	int *path = NULL; /* Árvore de caminho. */
-	int *dist = NULL; /* Tabela de dipathâncias à origem. */
+	int osrc, odst; /* Os mesmos, pela numeração original (ver g_permute()). */
+	int *dist = NULL; /* Tabela de distâncias à origem. */
+	int *path; /* Árvore de caminho (so->path, ou a da cache de árvores). */
 	int d;
+	int cost; /* Custo do caminho, ou código de erro (const.h). */
+	Landmarks *lm; /* Tabela de marcos para A*, se pedida. */
+	Hierarchy *ch; /* Hierarquia de contração, se pedida. */
+	Budget budget; /* Orçamento do problema. */
+	Budget *bp = NULL; /* &budget, se algum limite foi pedido. */
+	Counters cnt; /* Contadores da pesquisa, para as estatísticas. */
+	static const Counters no_work = {0, 0, 0, 0, 0, 0, 0};
+	const Result *r; /* Resultado guardado do problema, se houver. */
+	double start;
+
+	/* Palavras de tamanhos diferentes nunca estão ligadas. */
+	if (strlen(word2) != size) {
+		put_block(so->out, word1, NO_PATH, word2);
+		so_write(so, fpath);
+		so_query(so, word1, word2, max_perm, NO_PATH, NULL, 0);
+		return;
+	}
+
+	/* Se as duas palavras do .pal diferirem de 1 ou 0 carateres,
+	 * a solução é trivial. */
+	if ((d = w_diff(word1, word2, 1)) <= 1) {
+		put_block(so->out, word1, d, word2);
+		so_write(so, fpath);
+		so_query(so, word1, word2, max_perm, d, NULL, 0);
+		return;
+	}
 
-	/* TODO: Lift this while out or lift the body to another function */
-	while (fscanf(fpal, "%s %s %hu", word1, word2, &max_perm) == 3) {
-		/* Se as duas palavras do .pal diferirem de 1 ou 0 carateres,
-		 * a solução é trivial. */
-		if ((d = w_diff(word1, word2, 1)) <= 1) {
-			fprintf(fpath, "%s %d\n%s\n\n", word1, d, word2);
-			continue;
+	/* Depois do prazo do lote, os problemas restantes são apenas
+	 * marcados, para que o .path continue a ter um bloco por linha. */
+	if (batch_end > 0 && mono_time() > batch_end) {
+		put_block(so->out, word1, DEADLINE_EXCEEDED, word2);
+		so_write(so, fpath);
+		so_query(so, word1, word2, max_perm, DEADLINE_EXCEEDED, NULL, 0);
+		return;
+	}
+
+	/* Senão, temos de correr o algoritmo de caminho mais curto. Primeiro
+	 * procurar as palavras, o que só precisa dos vértices. */
+	g = so_acquire(so, graphs, size, max_perm, false);
+	src = g == NULL ? -1 : g_find_vertex(g, word1, w_cmp);
+	dst = g == NULL ? -1 : g_find_vertex(g, word2, w_cmp);
+
+	/* Palavras que não estão no dicionário não estão ligadas a nada. */
+	if (src == -1 || dst == -1) {
+		so_unlock(so, size, false);
+		put_block(so->out, word1, NO_PATH, word2);
+		so_write(so, fpath);
+		so_query(so, word1, word2, max_perm, NO_PATH, NULL, 0);
+		return;
+	}
+
+	/* A construção das arestas pode renumerar os vértices (--renumber);
+	 * a cache de resultados usa a numeração original. */
+	osrc = g_get_orig(g, src);
+	odst = g_get_orig(g, dst);
+
+	/* Problema já resolvido, neste sentido ou no outro (--result-cache):
+	 * as arestas deste limiar não chegam a ser precisas. */
+	if (options.result_cache) {
+		start = mono_time();
+		so_lock(so, 0, true);
+		r = rc_find(size, max_perm, osrc, odst);
+		so_unlock(so, 0, true);
+		if (r != NULL) {
+			put_result(so, g, r, osrc, word1, word2);
+			so_unlock(so, size, false);
+			so_write(so, fpath);
+			so_query(so, word1, word2, max_perm, rc_cost(r), &no_work,
+					mono_time() - start);
+			return;
 		}
+	}
 
-		/* Senão, temos de correr o algoritmo de caminho mais curto. */
-		g = graphs[strlen(word1)];
-		src = g_find_vertex(g, word1, w_cmp);
-		dst = g_find_vertex(g, word2, w_cmp);
+	/* Construir as arestas e o pré-processamento pedido para este
+	 * limiar antes de começar a contar o orçamento do problema. */
+	if (!prepared(graphs, size, max_perm, true)) {
+		so_unlock(so, size, false);
+		g = so_acquire(so, graphs, size, max_perm, true);
+		src = g_get_index(g, osrc);
+		dst = g_get_index(g, odst);
+	}
+	ch = NULL;
+	lm = NULL;
+	if (options.ch) {
+		ch = ch_select(g_get_hierarchies(g), max_perm*max_perm);
+	}
+	else if (options.alt_landmarks > 0) {
+		lm = lm_select(g_get_landmarks(g), max_perm*max_perm);
+	}
 
-		/* Realocar path para o tamanho corrente. */
-		path = realloc(path, g_get_size(g) * sizeof(int));
-		/* shortest_path() devolve dist e trata da sua realocação. */
-		dist = shortest_path(g, src, dst, path, max_perm*max_perm);
+	/* Realocar path para o tamanho corrente. */
+	if (so->size < g_get_size(g)) {
+		so->size = g_get_size(g);
+		so->path = (int *) erealloc(so->path, so->size * sizeof(int));
+		so->stack = (int *) erealloc(so->stack, so->size * sizeof(int));
+	}
 
-		if (path[dst] == -1) {
-			/* Não foi encotrado um caminho entre word1 e word2. */
-			fprintf(fpath, "%s %d\n%s\n", word1, -1, word2);
+	/* O prazo de cada problema nunca passa o prazo do lote. */
+	if (options.query_timeout > 0 || options.max_settled > 0 || batch_end > 0) {
+		bp = &budget;
+		budget.max_settled = options.max_settled;
+		budget.deadline = batch_end;
+		if (options.query_timeout > 0) {
+			budget.deadline = mono_time() + options.query_timeout / 1000.0;
+			if (batch_end > 0 && batch_end < budget.deadline) {
+				budget.deadline = batch_end;
+			}
 		}
-		else {
-			/* Foi encontrado um caminho. Temos de percorrer a árvore de
-			 * caminho path. */
-			fprintf(fpath, "%s %d\n", (char *) v_get_item(g_get_vertex(g, src)), dist[dst]);
-			fprint_path(fpath, g, path, dist, path[dst]);
-			fprintf(fpath, "%s\n", (char *) v_get_item(g_get_vertex(g, dst)));
+		budget.exceeded = false;
+	}
+
+	start = mono_time();
+	path = so->path;
+	if (ch != NULL) {
+		/* A hierarquia escreve em path apenas o caminho encontrado. */
+		cost = ch_query(ch, so->ch, src, dst, path, bp, &cnt);
+	}
+	else if (so->tc != NULL && lm == NULL) {
+		/* A árvore pode já estar (em parte) na cache. */
+		dist = sp_cached(so->tc, so->sp, g, size, src, dst, &path,
+				max_perm*max_perm, bp, &cnt);
+		cost = path[dst] == -1 ? NO_PATH : dist[dst];
+	}
+	else {
+		/* A tabela dist pertence às tabelas de trabalho de so. */
+		dist = shortest_path(so->sp, g, src, dst, path, max_perm*max_perm,
+				lm, bp, &cnt);
+		cost = path[dst] == -1 ? NO_PATH : dist[dst];
+	}
+	/* O caminho está em path e as palavras nunca mudam: o resto já
+	 * não precisa do grafo. */
+	so_unlock(so, size, false);
+
+	if (bp != NULL && budget.exceeded) {
+		cost = BUDGET_EXCEEDED;
+	}
+	/* Só os resultados (caminho ou NO_PATH) ficam, não as desistências. */
+	if (options.result_cache && cost >= NO_PATH) {
+		so_lock(so, 0, true);
+		rc_add(size, max_perm, osrc, odst, cost,
+				g_is_permuted(g) ? orig_tree(so, g, path, dst) : path);
+		so_unlock(so, 0, true);
+	}
+	so_query(so, word1, word2, max_perm, cost, &cnt, mono_time() - start);
+
+	if (cost < 0) {
+		/* Não foi encotrado um caminho entre word1 e word2, ou
+		 * desistimos de o procurar. */
+		put_block(so->out, word1, cost, word2);
+	}
+	else {
+		/* Foi encontrado um caminho. Temos de percorrer a árvore de
+		 * caminho path. */
+		put_path(so, g, path, dst, size, cost);
+	}
+	so_write(so, fpath);
+}
+
+/**
+ * @brief Verifica se a resposta a um problema precisa do grafo (ver
+ *	solve_problem()): palavras do mesmo tamanho, a mais de um carater.
+ *
+ * @param p Problema.
+ * @return Verdadeiro se for preciso pesquisar o grafo.
+ */
+bool pb_needs_graph(Problem *p)
+{
+	return strlen((char *) p->word2) == (size_t) p->size
+		&& w_diff(p->word1, p->word2, 1) > 1;
+}
+
+/**
+ * @brief Maior número de permutações dos problemas de cada tamanho de
+ *	palavra que precisam do grafo (ver pb_needs_graph()), 0 se nenhum.
+ *
+ * @param pb Tabela de problemas.
+ * @param n Número de problemas.
+ * @param max_perm Onde guardar os limiares (MAX_WORD_SIZE).
+ */
+static void pb_max_perms(Problem *pb, long n, unsigned short *max_perm)
+{
+	long j;
+	int i;
+
+	for (i = 0; i < MAX_WORD_SIZE; i++) {
+		max_perm[i] = 0;
+	}
+	for (j = 0; j < n; j++) {
+		if (pb_needs_graph(&pb[j]) && pb[j].max_perm > max_perm[pb[j].size]) {
+			max_perm[pb[j].size] = pb[j].max_perm;
+		}
+	}
+}
+
+/**
+ * @brief Constrói de uma vez as arestas de todos os grafos de que os
+ *	problemas precisam, com options.build_threads fios (ver build.c).
+ * @details Cada grafo é construído para o maior número de permutações dos
+ *	seus problemas. O pré-processamento (--alt, --ch) continua a ser
+ *	construído no primeiro problema que o pede.
+ *
+ * @param graphs Tabela de grafos.
+ * @param pb Tabela de problemas.
+ * @param n Número de problemas.
+ */
+static void build_all(Graph **graphs, Problem *pb, long n)
+{
+	unsigned short max_perm[MAX_WORD_SIZE];
+	Graph *todo[MAX_WORD_SIZE];
+	int size[MAX_WORD_SIZE];
+	double seconds[MAX_WORD_SIZE];
+	Graph *g;
+	int i, count = 0;
+
+	pb_max_perms(pb, n, max_perm);
+	for (i = 0; i < MAX_WORD_SIZE; i++) {
+		if (max_perm[i] > 0 && (g = load_graph(graphs, i)) != NULL
+				&& g_get_max_weight(g) < max_perm[i]*max_perm[i]) {
+			g_clear_edges(g, max_perm[i]);
+			todo[count] = g;
+			size[count] = i;
+			count++;
 		}
+	}
 
-		fprintf(fpath, "\n");
+	st_begin("g_make_edges");
+	bd_make_edges(todo, count, options.build_threads, w_diff, seconds);
+	st_end();
+	for (i = 0; i < count; i++) {
+		renumber(todo[i]);
+		pack(todo[i]);
+		st_graph(size[i], todo[i], seconds[i]);
 	}
+}
+
+/**
+ * @brief Ordem de resolução do modo --by-length: por tamanho de palavra e,
+ *	em cada tamanho, do maior para o menor número de permutações, para que
+ *	as arestas sejam construídas uma só vez. Comparador para qsort().
+ */
+static int pb_cmp(const void *a, const void *b)
+{
+	const Problem *p = (const Problem *) a, *q = (const Problem *) b;
+
+	if (p->size != q->size) {
+		return p->size - q->size;
+	}
+	if (p->max_perm != q->max_perm) {
+		return (int) q->max_perm - (int) p->max_perm;
+	}
+	return (p->line > q->line) - (p->line < q->line);
+}
 
-	free(dist);
-	free(path);
+/**
+ * @brief Comparador para qsort(): ordem do .pal.
+ */
+static int pb_cmp_line(const void *a, const void *b)
+{
+	const Problem *p = (const Problem *) a, *q = (const Problem *) b;
+
+	return (p->line > q->line) - (p->line < q->line);
 }
 
 /**
- * @brief Imprime caminho até ao vértice dst.
- * @details É necessário inverter o caminho. Para tal, esta
- * função é recursiva: dst é os sucessivo antecessor de path[dst].
+ * @brief Lê todo um ficheiro (ou stdin) para memória, com leituras grandes,
+ *	sem precisar de saber o tamanho nem de voltar atrás.
  *
- * @param fpath Ficheiro de saída .path.
- * @param g Grafo de tamanho de palavra pertinente.
- * @param path Árvore de caminho.
- * @param dist Tabela de dipathâncias.
- * @param dst Índice do vértice de destino na tabela de vértices (grafo).
+ * @param f Ficheiro.
+ * @param len Onde guardar o número de bytes lidos.
+ * @return Conteúdo, seguido de um '\0', a libertar com free().
  */
-void fprint_path(FILE *fpath, Graph *g, int *path, int *dist, int dst)
+static char *read_all(FILE *f, long *len)
 {
-	if (path[dst] == -1) return;
+	char *buf = NULL;
+	long max = 1 << 16;
+	size_t got;
+
+	*len = 0;
+	do {
+		max *= 2;
+		buf = (char *) erealloc(buf, max + 1);
+		got = fread(buf + *len, 1, max - *len, f);
+		*len += got;
+	} while (*len == max);
+	buf[*len] = '\0';
+
+	return buf;
+}
+
+/**
+ * @brief Lê uma palavra de um .pal em memória, como fscanf("%63s").
+ *
+ * @param cur Posição corrente, que avança.
+ * @param word Onde guardar a palavra (MAX_WORD_SIZE bytes).
+ * @return Falso no fim do texto.
+ */
+static bool scan_word(char **cur, char *word)
+{
+	char *p = *cur;
+	int n = 0;
+
+	while (isspace((unsigned char) *p)) {
+		p++;
+	}
+	while (*p != '\0' && !isspace((unsigned char) *p) && n < MAX_WORD_SIZE - 1) {
+		word[n++] = *p++;
+	}
+	word[n] = '\0';
+	*cur = p;
 
-	/* Enquanto ainda não estamos no fim do caminho chamar recursivamente, com
-	 * dst = antecessor de dst. */
-	fprint_path(fpath, g, path, dist, path[dst]);
-	/* Finalmente, quando chegamos ao fim, imprimir os vários vértices do
-	 * caminho. */
-	fprintf(fpath, "%s\n", (char *) v_get_item(g_get_vertex(g, dst)));
+	return n > 0;
+}
+
+/**
+ * @brief Lê um problema de um .pal em memória, como
+ *	fscanf("%63s %63s %hu").
+ *
+ * @param cur Posição corrente, que avança.
+ * @return Verdadeiro se leu um problema.
+ */
+static bool scan_problem(char **cur, char *word1, char *word2,
+		unsigned short *max_perm)
+{
+	char *end;
+	unsigned long value;
+
+	if (!scan_word(cur, word1) || !scan_word(cur, word2)) {
+		return false;
+	}
+	value = strtoul(*cur, &end, 10);
+	if (end == *cur) {
+		return false;
+	}
+	*max_perm = (unsigned short) value;
+	*cur = end;
+
+	return true;
+}
+
+/**
+ * @brief Palavras dos problemas, cada uma guardada uma só vez.
+ * @details data: as palavras, cada uma terminada em '\0'
+ *	used: bytes ocupados de data
+ *	slot: tabela de dispersão (endereçamento aberto) com a posição de cada
+ *	palavra em data mais 1, ou 0 se livre
+ *	slots, count: tamanho (potência de 2) e ocupação de slot
+ */
+typedef struct _WordPool {
+	char *data;
+	long used;
+	long *slot;
+	long slots;
+	long count;
+} WordPool;
+
+/**
+ * @brief Devolve a cópia de uma palavra guardada em wp, guardando-a se
+ *	ainda não lá estiver.
+ * @details data tem de ter sido criada com espaço para todas as palavras;
+ *	nunca é realocada, pelo que os ponteiros devolvidos ficam válidos.
+ */
+static char *wp_intern(WordPool *wp, const char *word)
+{
+	unsigned long h = w_hash((Item) word);
+	long i, j, *old;
+	size_t len;
+	char *copy;
+
+	for (i = h & (wp->slots - 1); wp->slot[i] != 0; i = (i + 1) & (wp->slots - 1)) {
+		if (strcmp(wp->data + wp->slot[i] - 1, word) == 0) {
+			return wp->data + wp->slot[i] - 1;
+		}
+	}
+
+	len = strlen(word) + 1;
+	copy = wp->data + wp->used;
+	memcpy(copy, word, len);
+	wp->slot[i] = wp->used + 1;
+	wp->used += len;
+
+	/* Tabela a mais de metade: duplicar e voltar a dispersar. */
+	if (++wp->count * 2 > wp->slots) {
+		old = wp->slot;
+		wp->slots *= 2;
+		wp->slot = (long *) ecalloc(wp->slots, sizeof(long));
+		for (j = 0; j < wp->slots / 2; j++) {
+			if (old[j] == 0) {
+				continue;
+			}
+			h = w_hash((Item) (wp->data + old[j] - 1));
+			for (i = h & (wp->slots - 1); wp->slot[i] != 0; i = (i + 1) & (wp->slots - 1))
+				;
+			wp->slot[i] = old[j];
+		}
+		free(old);
+	}
+
+	return copy;
+}
+
+/**
+ * @brief Lê todos os problemas do .pal, pela ordem do ficheiro.
+ * @details O ficheiro é lido para memória de uma vez e interpretado numa
+ *	só passagem, pelo que pode ser um pipe (stdin). As palavras de todos os
+ *	problemas ficam num único bloco, cada palavra distinta uma só vez.
+ *
+ *	O formato é o de options.pal_binary: texto, binário (.bpal, que tem
+ *	de começar pela identificação) ou, se for negativo, binário só se
+ *	começar pela identificação.
+ *
+ * @param fpal Ficheiro .pal de problemas.
+ * @param n Onde guardar o número de problemas.
+ * @param words Onde guardar o bloco das palavras.
+ * @return Tabela de problemas, a libertar com free_pal().
+ */
+Problem *read_pal(FILE *fpal, long *n, char **words)
+{
+	char word1[MAX_WORD_SIZE], word2[MAX_WORD_SIZE];
+	unsigned short max_perm;
+	Problem *pb = NULL;
+	long max = 0;
+	char *buf, *cur;
+	long len, r = 0;
+	bool binary;
+	WordPool wp;
+
+	st_begin("read_pal");
+	buf = read_all(fpal, &len);
+	cur = buf;
+	binary = len >= (long) sizeof(PAL_MAGIC)
+		&& memcmp(buf, PAL_MAGIC, sizeof(PAL_MAGIC)) == 0;
+	if (options.pal_binary > 0 && !binary) {
+		fprintf(stderr, "Erro: ficheiro de problemas binário sem identificação.\n");
+		exit(EXIT_FAILURE);
+	}
+	binary = binary && options.pal_binary != 0;
+	if (binary) {
+		cur += sizeof(PAL_MAGIC);
+	}
+
+	/* Cada palavra guardada ocupa no máximo os seus bytes no ficheiro
+	 * mais o '\0' (mais um '\0' por cada 63 carateres, se scan_word()
+	 * partir uma palavra comprida). */
+	wp.data = (char *) emalloc(len + len / (MAX_WORD_SIZE - 1) + 2);
+	wp.used = 0;
+	wp.slots = 1024;
+	wp.slot = (long *) ecalloc(wp.slots, sizeof(long));
+	wp.count = 0;
+
+	*n = 0;
+	while (binary ? (r = bin_scan_problem(cur, buf + len - cur, word1, word2,
+					&max_perm)) > 0
+			: scan_problem(&cur, word1, word2, &max_perm)) {
+		if (binary) {
+			cur += r;
+		}
+		if (*n == max) {
+			max = max ? 2 * max : 1024;
+			pb = (Problem *) erealloc(pb, max * sizeof(Problem));
+		}
+		pb[*n].word1 = wp_intern(&wp, word1);
+		pb[*n].word2 = wp_intern(&wp, word2);
+		pb[*n].max_perm = max_perm;
+		pb[*n].size = (int) strlen(word1);
+		pb[*n].line = *n;
+		pb[*n].out = NULL;
+		(*n)++;
+	}
+	if (r < 0) {
+		fprintf(stderr, "Erro: ficheiro de problemas corrompido.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	free(wp.slot);
+	free(buf);
+	*words = wp.data;
+	st_end();
+
+	return pb;
+}
+
+/**
+ * @brief Copia as respostas dos problemas, dos seus ficheiros temporários,
+ *	para o .path pela ordem do .pal.
+ * @details Deixa a tabela pela ordem do .pal.
+ *
+ * @param fpath Ficheiro .path de saída.
+ * @param pb Tabela de problemas, já resolvidos.
+ * @param n Número de problemas.
+ */
+void write_path(FILE *fpath, Problem *pb, long n)
+{
+	long i;
+
+	st_begin("write_path");
+	qsort(pb, n, sizeof(Problem), pb_cmp_line);
+	for (i = 0; i < n; i++) {
+		fseek(pb[i].out, pb[i].offset, SEEK_SET);
+		copy_bytes(pb[i].out, fpath, pb[i].length);
+	}
+	st_end();
+}
+
+/**
+ * @brief Liberta a tabela de problemas de read_pal().
+ *
+ * @param pb Tabela de problemas.
+ * @param words Bloco das palavras.
+ */
+void free_pal(Problem *pb, char *words)
+{
+	free(words);
+	free(pb);
+}
+
+/**
+ * @brief Modo --by-length: resolve os problemas um tamanho de palavra de
+ *	cada vez, para que só um grafo esteja em memória.
+ * @details O .pal é lido todo e ordenado por tamanho (ver pb_cmp()). Depois
+ *	de resolvidos os problemas de um tamanho, o seu grafo é libertado antes
+ *	de construir o seguinte. As respostas vão para um ficheiro temporário
+ *	e são copiadas para o .path pela ordem do .pal no fim. Com --pipeline,
+ *	a resolução é feita por pl_solve().
+ *
+ *	Com --batch-timeout, os problemas que ficam por resolver são os dos
+ *	últimos tamanhos, e não os das últimas linhas.
+ *
+ * @param fpal Ficheiro .pal de problemas.
+ * @param fpath Ficheiro .path de saída.
+ * @param graphs Tabela de grafos.
+ * @param so Estado de quem resolve.
+ * @param batch_end Prazo do lote (de mono_time()), 0 se não houver.
+ */
+static void solve_by_length(FILE *fpal, FILE *fpath, Graph **graphs, Solver *so,
+		double batch_end)
+{
+	Problem *pb;
+	char *words;
+	long n, i;
+	FILE *tmp;
+
+	pb = read_pal(fpal, &n, &words);
+	qsort(pb, n, sizeof(Problem), pb_cmp);
+
+	if (options.pipeline > 0) {
+		pl_solve(pb, n, fpath, graphs, batch_end);
+		free_pal(pb, words);
+		return;
+	}
+
+	if ((tmp = tmpfile()) == NULL) {
+		fprintf(stderr, "Erro: impossível criar ficheiro temporário.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (i = 0; i < n; i++) {
+		pb[i].out = tmp;
+		pb[i].offset = ftell(tmp);
+		solve_problem(tmp, graphs, (char *) pb[i].word1, (char *) pb[i].word2,
+				pb[i].max_perm, batch_end, so);
+		pb[i].length = ftell(tmp) - pb[i].offset;
+
+		/* Último problema deste tamanho: o grafo já não é preciso. */
+		if (i + 1 == n || pb[i+1].size != pb[i].size) {
+			so_release(so, graphs, pb[i].size);
+		}
+	}
+
+	write_path(fpath, pb, n);
+	fclose(tmp);
+	free_pal(pb, words);
+}
+
+/**
+ * @brief Encontrar caminho mais curto entre cada duas palavras do ficheiro
+ *	de problemas.
+ * @details O .pal é lido uma só vez (ver read_pal()). Por omissão, os
+ *	problemas são resolvidos pela ordem do .pal, cada grafo construído no
+ *	primeiro problema que precisa dele, logo para o maior número de
+ *	permutações do seu tamanho; com --by-length ou --pipeline, um tamanho
+ *	de palavra de cada vez (ver solve_by_length()); com --build-threads,
+ *	depois de construir todos os grafos em paralelo (ver build_all()).
+ *
+ * @param fpal Ficheiro .pal de problemas.
+ * @param fpath Ficheiro .path de saída com os caminhos e pesos correspondentes.
+ * @param graphs Tabela de grafos.
+ */
+void solve_pal(FILE *fpal, FILE *fpath, Graph **graphs)
+{
+	Solver *so = so_init(NULL, NULL);
+	double batch_end = 0; /* Prazo do lote, 0 se não houver. */
+	Problem *pb;
+	char *words;
+	long n, i;
+
+	if (options.batch_timeout > 0) {
+		batch_end = mono_time() + options.batch_timeout / 1000.0;
+	}
+
+	if (options.by_length || options.pipeline > 0) {
+		solve_by_length(fpal, fpath, graphs, so, batch_end);
+	}
+	else {
+		pb = read_pal(fpal, &n, &words);
+		pb_max_perms(pb, n, pal_perm);
+		if (options.build_threads > 1) {
+			build_all(graphs, pb, n);
+		}
+		for (i = 0; i < n; i++) {
+			solve_problem(fpath, graphs, (char *) pb[i].word1, (char *) pb[i].word2,
+					pb[i].max_perm, batch_end, so);
+		}
+		free_pal(pb, words);
+	}
+
+	so_free(so);
+}
+
+/**
+ * @brief Modo servidor: resolve os problemas lidos de in à medida que
+ *	chegam.
+ * @details Cada linha "palavra1 palavra2 permutações" dá um bloco em out,
+ *	igual ao do .path, escrito e despejado (fflush) logo que resolvido.
+ *	Linhas em branco são ignoradas; linhas mal formadas dão um bloco com
+ *	custo INVALID_PROBLEM. Cada grafo é construído no primeiro problema
+ *	que precisa dele (ver prepare()).
+ *	Não há prazo de lote (--batch-timeout não se aplica).
+ *
+ *	Vários fios de execução podem servir ao mesmo tempo, cada um com o seu
+ *	Solver, desde que este tenha as funções de acesso aos grafos.
+ *
+ * @param in Entrada de problemas (stdin, ou uma ligação do daemon).
+ * @param out Saída de caminhos.
+ * @param graphs Tabela de grafos, de read_dic().
+ * @param so Estado de quem resolve.
+ */
+void serve(FILE *in, FILE *out, Graph **graphs, Solver *so)
+{
+	char line[3 * MAX_WORD_SIZE];
+	char word1[MAX_WORD_SIZE], word2[MAX_WORD_SIZE];
+	unsigned short max_perm;
+	int n, c;
+
+	while (fgets(line, sizeof(line), in) != NULL) {
+		word1[0] = word2[0] = '\0';
+		/* Linha comprida de mais: descartar o resto (fica inválida). */
+		if (strchr(line, '\n') == NULL && !feof(in)) {
+			while ((c = fgetc(in)) != EOF && c != '\n')
+				;
+			line[0] = '\0';
+			n = -1;
+		}
+		else {
+			n = sscanf(line, "%63s %63s %hu", word1, word2, &max_perm);
+			if (n == EOF) {
+				continue;
+			}
+		}
+
+		if (n != 3) {
+			put_block(so->out, word1, INVALID_PROBLEM, word2);
+			so_write(so, out);
+		}
+		else {
+			solve_problem(out, graphs, word1, word2, max_perm, 0, so);
+		}
+		if (fflush(out) == EOF) {
+			/* O leitor foi-se embora. */
+			break;
+		}
+	}
 }
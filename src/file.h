@@ -13,14 +13,81 @@
 
 #include <stdio.h>
 
+#include "bool.h"
 #include "graph.h"
+#include "dijkstra.h"
+#include "ch.h"
+#include "outbuf.h"
 
-unsigned short *find_max_perms(FILE *fpal);
+/**
+ * @brief Estado de quem resolve problemas.
+ * @details sp, ch: tabelas de trabalho de shortest_path() e de ch_query()
+ *	tc: cache de árvores de caminhos (--tree-cache), NULL se não for pedida
+ *	path, size: árvore de caminho e o seu tamanho
+ *	stack: vértices de um caminho, do destino à origem (do mesmo tamanho)
+ *	out: buffer onde cada bloco de resposta é montado antes de escrito
+ *	lock, unlock: acesso aos grafos quando há vários fios de execução, NULL
+ *	se houver só um. lock(size, false) dá acesso partilhado ao grafo das
+ *	palavras de tamanho size, para pesquisar; lock(size, true) acesso
+ *	exclusivo, para construir arestas e pré-processamento; lock(0, true)
+ *	protege as estatísticas e a cache de resultados (result.c).
+ */
+typedef struct _Solver {
+	SpScratch *sp;
+	ChScratch *ch;
+	TreeCache *tc;
+	int *path;
+	int *stack;
+	int size;
+	OutBuf *out;
+	void (*lock)(int size, bool exclusive);
+	void (*unlock)(int size, bool exclusive);
+} Solver;
+
+/**
+ * @brief Problema do .pal (ver read_pal()).
+ * @details word1, word2, max_perm: o problema, como no .pal; as palavras
+ *	estão no bloco de palavras de read_pal()
+ *	size: tamanho de palavra de word1, que decide o grafo
+ *	line: posição do problema no .pal
+ *	out, offset, length: ficheiro temporário com a resposta e posição e
+ *	tamanho do seu bloco
+ */
+typedef struct _Problem {
+	Item word1;
+	Item word2;
+	unsigned short max_perm;
+	int size;
+	long line;
+	FILE *out;
+	long offset;
+	long length;
+} Problem;
+
+Graph **read_dic(FILE *fdic);
+
+Solver *so_init(void (*lock)(int size, bool exclusive),
+		void (*unlock)(int size, bool exclusive));
+void so_free(Solver *so);
+
+void so_prepare(Solver *so, Graph **graphs, int size, unsigned short max_perm);
+void so_release(Solver *so, Graph **graphs, int size);
+void solve_problem(FILE *fpath, Graph **graphs, char *word1, char *word2,
+		unsigned short max_perm, double batch_end, Solver *so);
 
-Graph **read_dic(FILE *fdic, unsigned short *max_perms);
+Problem *read_pal(FILE *fpal, long *n, char **words);
+bool pb_needs_graph(Problem *p);
+void write_path(FILE *fpath, Problem *pb, long n);
+void free_pal(Problem *pb, char *words);
 
 void solve_pal(FILE *fpal, FILE *fpath, Graph **graphs);
+void serve(FILE *in, FILE *out, Graph **graphs, Solver *so);
 
-void fprint_path(FILE *fpath, Graph *g, int *st, int *wt, int dst);
+Landmarks *find_landmarks(Graph *g, unsigned short max_weight);
+Hierarchy *find_hierarchy(Graph *g, unsigned short max_weight);
+void load_landmarks(const char *name, Graph **graphs);
+void save_landmarks(const char *name, Graph **graphs);
+void load_results(const char *name);
+void save_results(const char *name);
 
 #endif
@@ -0,0 +1,701 @@
+/**
+ * @file gendic.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Gerador de dicionários e problemas sintéticos.
+ * @details
+ *	Gera um .dic com um número de palavras, distribuição de tamanhos e
+ *	alfabeto dados. A densidade de vizinhos é controlada pela fração de
+ *	palavras que são mutações (de 1 a --mutations letras) de uma palavra já
+ *	gerada do mesmo tamanho; as restantes são aleatórias. Palavras de um
+ *	dicionário existente (--seed-dic) podem servir de sementes.
+ *
+ *	Opcionalmente gera também um .pal. Os problemas com caminho são obtidos
+ *	por pesquisa em largura a partir da palavra de partida, até um número de
+ *	passos dado (--path-length), onde um passo muda até --perms letras. Os
+ *	problemas sem caminho usam como destino uma palavra isolada (sem
+ *	nenhuma palavra a --perms letras ou menos), acrescentada ao dicionário.
+ *	Para encontrar vizinhos, cada palavra é indexada por todas as formas de
+ *	tapar --perms das suas letras: duas palavras com uma chave em comum
+ *	diferem no máximo em --perms letras. O índice tem C(tamanho, perms)
+ *	entradas por palavra, pelo que --perms deve ser pequeno (1 a 3).
+ *
+ *	Utilização: gendic [opções] saída.dic [saída.pal]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "const.h"
+#include "utils.h"
+#include "word.h"
+
+/* Vértices visitados no máximo por cada pesquisa em largura: em grafos
+ * densos, os caminhos longos pedidos ficam mais curtos. */
+#define MAX_BFS 20000
+/* Tentativas de gerar uma palavra nova antes de desistir. */
+#define MAX_TRIES 1000
+/* Origens tentadas para obter um caminho com os passos pedidos. */
+#define MAX_WALKS 10
+
+/**
+ * @brief Parâmetros do gerador.
+ */
+typedef struct _GenOptions {
+	long words;
+	double weights[MAX_WORD_SIZE]; /* Peso relativo de cada tamanho. */
+	int alphabet;
+	double density;
+	int mutations;
+	char *seed_dic;
+	long problems;
+	double unreachable;
+	int perms;
+	int min_steps, max_steps;
+	unsigned long seed;
+} GenOptions;
+
+/* Palavras geradas e tabela de dispersão (índice + 1, 0 se livre). */
+static char **words = NULL;
+static long num_words = 0, max_words = 0;
+static long *table = NULL;
+static unsigned long table_size = 0;
+
+/* Índices das palavras de cada tamanho. */
+static long *by_len[MAX_WORD_SIZE];
+static long len_count[MAX_WORD_SIZE], len_max[MAX_WORD_SIZE];
+
+/**
+ * @brief Posição do índice de vizinhos: dispersão de uma chave tapada e
+ *	primeira entrada (+ 1, 0 se a posição estiver livre) da lista de
+ *	palavras com essa chave.
+ */
+typedef struct _Slot {
+	unsigned long hash;
+	long head;
+} Slot;
+
+static Slot *nb_table = NULL;
+static unsigned long nb_size = 0, nb_used = 0;
+/* Entradas: palavra e entrada seguinte (+ 1) da mesma chave. */
+static long *nb_word = NULL, *nb_next = NULL;
+static long nb_entries = 0, nb_max = 0;
+static int nb_perms = 1;
+
+/* Estado da pesquisa em largura. */
+static long *bfs_queue = NULL;
+static long *bfs_mark = NULL;
+static int *bfs_depth = NULL;
+static long bfs_stamp = 0, bfs_tail = 0;
+static int bfs_cur = 0;
+static int bfs_goal = 0;
+
+static unsigned long rng;
+
+/**
+ * @brief Gerador pseudo-aleatório (xorshift).
+ */
+static unsigned long gen_rand(void)
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 7;
+	rng ^= rng << 17;
+	return rng & 0xffffffffUL;
+}
+
+/**
+ * @brief Número pseudo-aleatório em [0, 1).
+ */
+static double gen_uniform(void)
+{
+	return gen_rand() / 4294967296.0;
+}
+
+/**
+ * @brief Procura uma palavra na tabela de dispersão.
+ *
+ * @param w Palavra.
+ * @return Índice da palavra, -1 se não existir.
+ */
+static long set_find(char *w)
+{
+	unsigned long i = w_hash(w) & (table_size - 1);
+
+	while (table[i] != 0) {
+		if (strcmp(words[table[i] - 1], w) == 0) {
+			return table[i] - 1;
+		}
+		i = (i + 1) & (table_size - 1);
+	}
+	return -1;
+}
+
+/**
+ * @brief Acrescenta uma palavra ao dicionário, se ainda não existir.
+ *
+ * @param w Palavra (copiada).
+ * @return Índice da nova palavra, -1 se já existia.
+ */
+static long set_add(char *w)
+{
+	unsigned long i, j;
+	size_t len = strlen(w);
+
+	/* Manter a tabela no máximo meio cheia. */
+	if (2 * (unsigned long) (num_words + 1) > table_size) {
+		free(table);
+		table_size = table_size ? 2 * table_size : 1024;
+		table = (long *) ecalloc(table_size, sizeof(long));
+		for (j = 0; j < (unsigned long) num_words; j++) {
+			i = w_hash(words[j]) & (table_size - 1);
+			while (table[i] != 0) {
+				i = (i + 1) & (table_size - 1);
+			}
+			table[i] = j + 1;
+		}
+	}
+	if (set_find(w) != -1) {
+		return -1;
+	}
+
+	if (num_words == max_words) {
+		max_words = max_words ? 2 * max_words : 1024;
+		words = (char **) erealloc(words, max_words * sizeof(char *));
+	}
+	words[num_words] = (char *) w_new(w);
+
+	i = w_hash(w) & (table_size - 1);
+	while (table[i] != 0) {
+		i = (i + 1) & (table_size - 1);
+	}
+	table[i] = num_words + 1;
+
+	if (len_count[len] == len_max[len]) {
+		len_max[len] = len_max[len] ? 2 * len_max[len] : 64;
+		by_len[len] = (long *) erealloc(by_len[len], len_max[len] * sizeof(long));
+	}
+	by_len[len][len_count[len]++] = num_words;
+
+	return num_words++;
+}
+
+/**
+ * @brief Sorteia um tamanho de palavra segundo os pesos dados.
+ */
+static int pick_len(GenOptions *o, double total)
+{
+	double x = gen_uniform() * total;
+	int len;
+
+	for (len = 1; len < MAX_WORD_SIZE - 1; len++) {
+		if ((x -= o->weights[len]) < 0) {
+			break;
+		}
+	}
+	return len;
+}
+
+/**
+ * @brief Muda k letras (posições distintas) de w para letras diferentes
+ *	do alfabeto.
+ */
+static void mutate(char *w, int len, int k, int alphabet)
+{
+	int pos, i;
+	char c;
+
+	for (i = 0; i < k && i < len; i++) {
+		pos = gen_rand() % len;
+		do {
+			c = 'a' + gen_rand() % alphabet;
+		} while (c == w[pos] && alphabet > 1);
+		w[pos] = c;
+	}
+}
+
+/**
+ * @brief Dispersão de w com as posições pos[0..k-1] tapadas.
+ */
+static unsigned long masked_hash(const char *w, int *pos, int k)
+{
+	char buffer[MAX_WORD_SIZE];
+	int i;
+
+	strcpy(buffer, w);
+	for (i = 0; i < k; i++) {
+		/* Carácter que não aparece em palavras. */
+		buffer[pos[i]] = '\1';
+	}
+	return w_hash(buffer);
+}
+
+/**
+ * @brief Próxima combinação de k posições de entre len, por ordem
+ *	lexicográfica.
+ *
+ * @return Falso se pos já era a última combinação.
+ */
+static int next_combination(int *pos, int k, int len)
+{
+	int i, j;
+
+	for (i = k - 1; i >= 0 && pos[i] == len - k + i; i--)
+		;
+	if (i < 0) {
+		return 0;
+	}
+	pos[i]++;
+	for (j = i + 1; j < k; j++) {
+		pos[j] = pos[j-1] + 1;
+	}
+	return 1;
+}
+
+/**
+ * @brief Posição do índice com a dispersão h, ou a posição livre onde
+ *	esta deve ser inserida.
+ */
+static unsigned long nb_find(unsigned long h)
+{
+	/* Misturar os bits: chaves parecidas dão dispersões parecidas. */
+	unsigned long i = ((h ^ (h >> 16)) * 2654435761UL) & (nb_size - 1);
+
+	while (nb_table[i].head != 0 && nb_table[i].hash != h) {
+		i = (i + 1) & (nb_size - 1);
+	}
+	return i;
+}
+
+/**
+ * @brief Acrescenta uma palavra ao índice de vizinhos.
+ *
+ * @param idx Índice da palavra.
+ */
+static void nb_add(long idx)
+{
+	int pos[MAX_WORD_SIZE];
+	int len = strlen(words[idx]);
+	int k = nb_perms < len ? nb_perms : len;
+	unsigned long h, i, j;
+	Slot *old;
+
+	for (i = 0; i < (unsigned long) k; i++) {
+		pos[i] = i;
+	}
+	do {
+		/* Manter o índice no máximo meio cheio. */
+		if (2 * (nb_used + 1) > nb_size) {
+			old = nb_table;
+			nb_size = nb_size ? 2 * nb_size : 1024;
+			nb_table = (Slot *) ecalloc(nb_size, sizeof(Slot));
+			for (j = 0; old != NULL && j < nb_size / 2; j++) {
+				if (old[j].head != 0) {
+					nb_table[nb_find(old[j].hash)] = old[j];
+				}
+			}
+			free(old);
+		}
+		if (nb_entries == nb_max) {
+			nb_max = nb_max ? 2 * nb_max : 1024;
+			nb_word = (long *) erealloc(nb_word, nb_max * sizeof(long));
+			nb_next = (long *) erealloc(nb_next, nb_max * sizeof(long));
+		}
+
+		h = masked_hash(words[idx], pos, k);
+		i = nb_find(h);
+		if (nb_table[i].head == 0) {
+			nb_table[i].hash = h;
+			nb_used++;
+		}
+		nb_word[nb_entries] = idx;
+		nb_next[nb_entries] = nb_table[i].head;
+		nb_table[i].head = ++nb_entries;
+	} while (next_combination(pos, k, len));
+}
+
+/**
+ * @brief Percorre as palavras do dicionário que diferem de w em 1 a
+ *	nb_perms letras.
+ * @details Uma palavra pode ser visitada mais do que uma vez (se diferir
+ *	em menos de nb_perms letras, partilha várias chaves com w).
+ *
+ * @param w Palavra.
+ * @param visit Chamada para cada vizinho; se devolver verdadeiro, a
+ *	pesquisa pára.
+ * @return Verdadeiro se visit parou a pesquisa.
+ */
+static int for_neighbors(const char *w, int (*visit)(long))
+{
+	int pos[MAX_WORD_SIZE];
+	int len = strlen(w);
+	int k = nb_perms < len ? nb_perms : len;
+	unsigned long i;
+	long e;
+	char *c;
+
+	for (i = 0; i < (unsigned long) k; i++) {
+		pos[i] = i;
+	}
+	do {
+		i = nb_find(masked_hash(w, pos, k));
+		for (e = nb_table[i].head; e != 0; e = nb_next[e - 1]) {
+			/* Colisões da dispersão são filtradas aqui. */
+			c = words[nb_word[e - 1]];
+			if (strlen(c) == (size_t) len && strcmp(c, w) != 0
+					&& w_diff(c, (char *) w, nb_perms) <= nb_perms
+					&& visit(nb_word[e - 1])) {
+				return 1;
+			}
+		}
+	} while (next_combination(pos, k, len));
+
+	return 0;
+}
+
+/**
+ * @brief visit de for_neighbors() que pára no primeiro vizinho.
+ */
+static int any_neighbor(long idx)
+{
+	(void) idx;
+	return 1;
+}
+
+/**
+ * @brief visit de for_neighbors() da pesquisa em largura.
+ * @details Pára ao descobrir um vértice à distância pretendida (que fica
+ *	no fim da fila) ou ao atingir o limite de vértices.
+ */
+static int bfs_visit(long idx)
+{
+	if (bfs_mark[idx] != bfs_stamp) {
+		bfs_mark[idx] = bfs_stamp;
+		bfs_depth[idx] = bfs_cur + 1;
+		bfs_queue[bfs_tail++] = idx;
+		return bfs_cur + 1 == bfs_goal || bfs_tail >= MAX_BFS;
+	}
+	return 0;
+}
+
+/**
+ * @brief Palavra a steps passos de src (cada passo muda até nb_perms letras).
+ *
+ * @return Índice da palavra, ou da mais distante alcançada se nenhuma
+ *	estiver a steps passos; -1 se src não tiver vizinhos.
+ */
+static long walk(long src, int steps)
+{
+	long head = 0, v;
+
+	bfs_stamp++;
+	bfs_tail = 0;
+	bfs_goal = steps;
+	bfs_mark[src] = bfs_stamp;
+	bfs_depth[src] = 0;
+	bfs_queue[bfs_tail++] = src;
+
+	while (head < bfs_tail) {
+		v = bfs_queue[head++];
+		bfs_cur = bfs_depth[v];
+		if (for_neighbors(words[v], bfs_visit)) {
+			break;
+		}
+	}
+
+	/* A fila está por ordem de distância: o último é o mais distante. */
+	v = bfs_queue[bfs_tail - 1];
+	return v == src ? -1 : v;
+}
+
+/**
+ * @brief Acrescenta ao dicionário uma palavra sem vizinhos.
+ *
+ * @return Índice da palavra, -1 se não foi possível encontrar uma.
+ */
+static long add_island(int len, int alphabet)
+{
+	char w[MAX_WORD_SIZE];
+	long idx;
+	int i, t;
+
+	for (t = 0; t < MAX_TRIES; t++) {
+		for (i = 0; i < len; i++) {
+			w[i] = 'a' + gen_rand() % alphabet;
+		}
+		w[len] = '\0';
+		if (set_find(w) == -1 && !for_neighbors(w, any_neighbor)) {
+			idx = set_add(w);
+			nb_add(idx);
+			return idx;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @brief Gera as palavras do dicionário.
+ */
+static void gen_words(GenOptions *o)
+{
+	char w[MAX_WORD_SIZE];
+	double total = 0;
+	long fails = 0;
+	int len, i;
+
+	for (len = 1; len < MAX_WORD_SIZE; len++) {
+		total += o->weights[len];
+	}
+
+	while (num_words < o->words && fails < MAX_TRIES) {
+		len = pick_len(o, total);
+		if (len_count[len] > 0 && gen_uniform() < o->density) {
+			strcpy(w, words[by_len[len][gen_rand() % len_count[len]]]);
+			mutate(w, len, 1 + gen_rand() % o->mutations, o->alphabet);
+		}
+		else {
+			for (i = 0; i < len; i++) {
+				w[i] = 'a' + gen_rand() % o->alphabet;
+			}
+			w[len] = '\0';
+		}
+		fails = set_add(w) == -1 ? fails + 1 : 0;
+	}
+
+	if (num_words < o->words) {
+		fprintf(stderr, "Aviso: só foi possível gerar %ld palavras.\n", num_words);
+	}
+}
+
+/**
+ * @brief Gera os problemas e escreve-os em f.
+ */
+static void gen_problems(GenOptions *o, FILE *f)
+{
+	long p, src = 0, dst, v, total = 0;
+	long x;
+	int len, steps, t, depth, unreachable;
+
+	/* As palavras isoladas acrescentadas contam para o tamanho das tabelas. */
+	bfs_queue = (long *) emalloc(MAX_BFS * sizeof(long));
+	bfs_mark = (long *) ecalloc(num_words + o->problems, sizeof(long));
+	bfs_depth = (int *) emalloc((num_words + o->problems) * sizeof(int));
+
+	for (len = 1; len < MAX_WORD_SIZE; len++) {
+		total += len_count[len];
+	}
+	nb_perms = o->perms;
+	for (p = 0; p < num_words; p++) {
+		nb_add(p);
+	}
+
+	for (p = 0; p < o->problems; p++) {
+		unreachable = gen_uniform() < o->unreachable;
+		steps = o->min_steps + gen_rand() % (o->max_steps - o->min_steps + 1);
+		dst = -1;
+		depth = 0;
+		for (t = 0; t < MAX_TRIES && (dst == -1 || (!unreachable
+				&& depth < steps && t < MAX_WALKS)); t++) {
+			/* Tamanho com probabilidade proporcional ao número de palavras. */
+			x = gen_rand() % total;
+			for (len = 1; x >= len_count[len]; len++) {
+				x -= len_count[len];
+			}
+
+			if (unreachable) {
+				src = by_len[len][x];
+				dst = add_island(len, o->alphabet);
+			}
+			/* Componentes pequenas não chegam à distância pedida: ficamos
+			 * com o par mais distante de entre MAX_WALKS origens. */
+			else if ((v = walk(by_len[len][x], steps)) != -1 && bfs_depth[v] > depth) {
+				src = by_len[len][x];
+				dst = v;
+				depth = bfs_depth[v];
+			}
+		}
+		if (dst == -1) {
+			fprintf(stderr, "Aviso: só foi possível gerar %ld problemas.\n", p);
+			break;
+		}
+		fprintf(f, "%s %s %d\n", words[src], words[dst], o->perms);
+	}
+
+	free(bfs_queue);
+	free(bfs_mark);
+	free(bfs_depth);
+	free(nb_table);
+	free(nb_word);
+	free(nb_next);
+}
+
+/**
+ * @brief Lê a distribuição de tamanhos, da forma "4:1,5:2.5,6:3".
+ *
+ * @return 0 em caso de sucesso, -1 se for inválida.
+ */
+static int parse_lengths(const char *spec, double *weights)
+{
+	char *end;
+	long len;
+	int i;
+
+	for (i = 0; i < MAX_WORD_SIZE; i++) {
+		weights[i] = 0;
+	}
+	while (*spec != '\0') {
+		len = strtol(spec, &end, 10);
+		if (end == spec || *end != ':' || len < 1 || len >= MAX_WORD_SIZE - 1) {
+			return -1;
+		}
+		spec = end + 1;
+		weights[len] = strtod(spec, &end);
+		if (end == spec || weights[len] < 0) {
+			return -1;
+		}
+		spec = *end == ',' ? end + 1 : end;
+	}
+	return 0;
+}
+
+/**
+ * @brief Imprime a forma de utilização do programa.
+ */
+static void gen_usage(const char *prog)
+{
+	fprintf(stderr, "Utilização: %s [opções] saída.dic [saída.pal]\n"
+		"  --words=N        número de palavras (100000)\n"
+		"  --lengths=L:P,.. pesos dos tamanhos (4:1,5:2,6:3,7:3,8:3,9:2,10:1)\n"
+		"  --alphabet=K     letras a.. (26)\n"
+		"  --density=D      fração de palavras obtidas por mutação (0.5)\n"
+		"  --mutations=M    letras mudadas por mutação, 1 a M (1)\n"
+		"  --seed-dic=F     palavras iniciais, lidas de F\n", prog);
+	fprintf(stderr, "  --problems=N     número de problemas do .pal (1000)\n"
+		"  --unreachable=U  fração de problemas sem caminho (0.1)\n"
+		"  --perms=P        permutações por passo dos problemas (2)\n"
+		"  --path-length=A[-B]  passos dos problemas com caminho (3-8)\n"
+		"  --seed=S         semente do gerador pseudo-aleatório (1)\n");
+}
+
+int main(int argc, char **argv)
+{
+	GenOptions o;
+	FILE *fdic, *fpal, *fseed;
+	char buffer[MAX_WORD_SIZE];
+	char *value, *end;
+	int i, len;
+	long k;
+
+	o.words = 100000;
+	parse_lengths("4:1,5:2,6:3,7:3,8:3,9:2,10:1", o.weights);
+	o.alphabet = 26;
+	o.density = 0.5;
+	o.mutations = 1;
+	o.seed_dic = NULL;
+	o.problems = 1000;
+	o.unreachable = 0.1;
+	o.perms = 2;
+	o.min_steps = 3;
+	o.max_steps = 8;
+	o.seed = 1;
+
+	for (i = 1; i < argc && strncmp(argv[i], "--", 2) == 0; i++) {
+		value = strchr(argv[i], '=');
+		if (value == NULL) {
+			gen_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		value++;
+		if (strncmp(argv[i], "--words=", 8) == 0) {
+			o.words = atol(value);
+		}
+		else if (strncmp(argv[i], "--lengths=", 10) == 0) {
+			if (parse_lengths(value, o.weights) != 0) {
+				gen_usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+		}
+		else if (strncmp(argv[i], "--alphabet=", 11) == 0) {
+			o.alphabet = atoi(value);
+		}
+		else if (strncmp(argv[i], "--density=", 10) == 0) {
+			o.density = atof(value);
+		}
+		else if (strncmp(argv[i], "--mutations=", 12) == 0) {
+			o.mutations = atoi(value);
+		}
+		else if (strncmp(argv[i], "--seed-dic=", 11) == 0) {
+			o.seed_dic = value;
+		}
+		else if (strncmp(argv[i], "--problems=", 11) == 0) {
+			o.problems = atol(value);
+		}
+		else if (strncmp(argv[i], "--unreachable=", 14) == 0) {
+			o.unreachable = atof(value);
+		}
+		else if (strncmp(argv[i], "--perms=", 8) == 0) {
+			o.perms = atoi(value);
+		}
+		else if (strncmp(argv[i], "--path-length=", 14) == 0) {
+			o.min_steps = o.max_steps = strtol(value, &end, 10);
+			if (*end == '-') {
+				o.max_steps = atoi(end + 1);
+			}
+		}
+		else if (strncmp(argv[i], "--seed=", 7) == 0) {
+			o.seed = strtoul(value, NULL, 10);
+		}
+		else {
+			gen_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (argc - i < 1 || argc - i > 2 || o.alphabet < 1 || o.alphabet > 26
+			|| o.mutations < 1 || o.perms < 1 || o.min_steps < 1
+			|| o.max_steps < o.min_steps) {
+		gen_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	/* xorshift não pode começar em 0. */
+	rng = o.seed * 2654435761UL + 1;
+
+	if (o.seed_dic != NULL) {
+		fseed = efopen(o.seed_dic, "r");
+		while (num_words < o.words && fscanf(fseed, "%63s", buffer) == 1) {
+			set_add(buffer);
+		}
+		fclose(fseed);
+	}
+	gen_words(&o);
+
+	if (argc - i == 2) {
+		fpal = efopen(argv[i + 1], "w");
+		gen_problems(&o, fpal);
+		fclose(fpal);
+	}
+
+	/* O dicionário é escrito no fim, com as palavras isoladas dos
+	 * problemas sem caminho. */
+	fdic = efopen(argv[i], "w");
+	for (k = 0; k < num_words; k++) {
+		fprintf(fdic, "%s\n", words[k]);
+	}
+	fclose(fdic);
+
+	for (len = 1; len < MAX_WORD_SIZE; len++) {
+		if (len_count[len] > MAX_VERTICES) {
+			fprintf(stderr, "Aviso: %ld palavras de tamanho %d, mais do que "
+				"as %d que o wordmorph aceita.\n", len_count[len], len,
+				MAX_VERTICES);
+		}
+		free(by_len[len]);
+	}
+	for (k = 0; k < num_words; k++) {
+		w_free(words[k]);
+	}
+	free(words);
+	free(table);
+
+	return EXIT_SUCCESS;
+}
@@ -15,6 +15,7 @@
 #include "utils.h"
 #include "bool.h"
 #include "heap.h"
+#include "packed.h"
 
 /**
  * @brief Vértice de um grafo
@@ -45,6 +46,13 @@ struct _Edge {
  *	size: número máximo de vértices que o grafo pode conter
  *	free: número de vértices que o grafo contém (posição livre)
  *	max_weight: peso máximo das arestas do grafo
+ *	edges: número de arestas (não orientadas) do grafo
+ *	landmarks: lista de tabelas de marcos (ALT) do grafo, NULL se não houver
+ *	hierarchies: lista de hierarquias de contração do grafo, NULL se não houver
+ *	orig, rank: depois de g_permute(), índice original (de g_insert()) de
+ *	cada vértice e índice atual de cada índice original; NULL antes
+ *	packed: listas de adjacências comprimidas por g_pack(), que substituem
+ *	as listas ligadas; NULL se não houver
  *
  */
 struct _Graph {
@@ -52,6 +60,12 @@ struct _Graph {
 	unsigned short size;
 	unsigned short free;
 	unsigned short max_weight;
+	unsigned long edges;
+	Landmarks *landmarks;
+	Hierarchy *hierarchies;
+	unsigned short *orig;
+	unsigned short *rank;
+	Packed *packed;
 };
 
 
@@ -69,6 +83,12 @@ Graph *g_init(unsigned short size, unsigned short max_weight)
 	g->free = 0;
 	g->size = size;
 	g->max_weight = max_weight;
+	g->edges = 0;
+	g->landmarks = NULL;
+	g->hierarchies = NULL;
+	g->orig = NULL;
+	g->rank = NULL;
+	g->packed = NULL;
 
 	return g;
 }
@@ -91,6 +111,9 @@ void g_free(Graph *g, void (free_item)(Item item))
 	}
 
 	free(g->vértices);
+	free(g->orig);
+	free(g->rank);
+	pk_free(g->packed);
 	free(g);
 }
 
@@ -135,6 +158,29 @@ void g_make_edges(Graph *g, unsigned short (*calc_weight)(Item i1, Item i2, unsi
 	g->max_weight *= g->max_weight;
 }
 
+/**
+ * @brief Remove todas as arestas do grafo (e as listas comprimidas, se
+ *	houver), para as voltar a construir com g_make_edges() com outro peso
+ *	máximo.
+ *
+ * @param g Ponteiro para grafo.
+ * @param max_weight Novo peso máximo das arestas (antes de g_make_edges()
+ *	o elevar ao quadrado, como em g_init()).
+ */
+void g_clear_edges(Graph *g, unsigned short max_weight)
+{
+	unsigned short i;
+
+	for (i = 0; i < g->free; i++) {
+		free_adj(g->vértices[i]->adj);
+		g->vértices[i]->adj = NULL;
+	}
+	pk_free(g->packed);
+	g->packed = NULL;
+	g->edges = 0;
+	g->max_weight = max_weight;
+}
+
 /**
  * @brief Função assessora do numero máximo de vértices no grafo.
  *
@@ -168,6 +214,45 @@ unsigned short g_get_max_weight(Graph *g)
 	return g->max_weight;
 }
 
+/**
+ * @brief Muda o peso máximo das arestas do grafo.
+ * @details Para quem constrói as arestas sem g_make_edges() (ver build.c),
+ *	que no fim tem de deixar o peso máximo ao quadrado, como esta.
+ *
+ * @param g Ponteiro para grafo.
+ * @param max_weight Peso máximo das arestas.
+ */
+void g_set_max_weight(Graph *g, unsigned short max_weight)
+{
+	g->max_weight = max_weight;
+}
+
+/**
+ * @brief Função assessora do número de arestas do grafo.
+ *
+ * @param g Ponteiro para grafo.
+ * @return Número de arestas, contando uma vez cada ligação entre dois vértices.
+ */
+unsigned long g_get_edges(Graph *g)
+{
+	return g->edges;
+}
+
+/**
+ * @brief Memória ocupada pela estrutura do grafo.
+ * @details Conta o grafo, os vértices e as listas de adjacências (duas
+ *	arestas por ligação); os items não são incluídos.
+ *
+ * @param g Ponteiro para grafo.
+ * @return Número de bytes.
+ */
+size_t g_get_bytes(Graph *g)
+{
+	return sizeof(Graph) + g->size * (sizeof(Vertex *) + sizeof(Vertex))
+		+ (g->packed != NULL ? pk_get_bytes(g->packed) : 2 * g->edges * sizeof(Edge))
+		+ (g->orig != NULL ? 2 * g->size * sizeof(unsigned short) : 0);
+}
+
 /**
  * @brief Função assessora de um vértice i do grafo.
  *
@@ -183,7 +268,9 @@ Vertex *g_get_vertex(Graph *g, unsigned short i)
 
 /**
  * @brief Encontra vértice no grafo.
- * @details Procura um vértice no grafo linearmente.
+ * @details Procura um vértice no grafo linearmente, pela ordem original
+ *	dos vértices, para que com items repetidos o resultado não dependa de
+ *	g_permute().
  *
  * @param g Ponteiro para grafo.
  * @param i1 Item que identifica o vértice a encontrar
@@ -192,15 +279,254 @@ Vertex *g_get_vertex(Graph *g, unsigned short i)
  */
 int g_find_vertex(Graph *g, Item i1, int (*cmp_item)(Item c1, Item c2))
 {
-	int i;
+	int i, v;
 
-	for (i = 0; i < g_get_size(g); i++)
-		if (!cmp_item(g->vértices[i]->item, i1))
-			return i;
+	for (i = 0; i < g_get_size(g); i++) {
+		v = g->rank != NULL ? g->rank[i] : i;
+		if (!cmp_item(g->vértices[v]->item, i1))
+			return v;
+	}
 
 	return -1;
 }
 
+/**
+ * @brief Verifica se os vértices do grafo já foram renumerados por
+ *	g_permute().
+ *
+ * @param g Ponteiro para grafo.
+ * @return Verdadeiro se a numeração não for a de g_insert().
+ */
+bool g_is_permuted(Graph *g)
+{
+	return g->orig != NULL;
+}
+
+/**
+ * @brief Índice original (pela ordem de g_insert()) de um vértice.
+ *
+ * @param g Ponteiro para grafo.
+ * @param v Índice atual do vértice.
+ * @return Índice original.
+ */
+unsigned short g_get_orig(Graph *g, unsigned short v)
+{
+	return g->orig != NULL ? g->orig[v] : v;
+}
+
+/**
+ * @brief Índice atual do vértice com um índice original.
+ *
+ * @param g Ponteiro para grafo.
+ * @param i Índice original (ver g_get_orig()).
+ * @return Índice atual.
+ */
+unsigned short g_get_index(Graph *g, unsigned short i)
+{
+	return g->rank != NULL ? g->rank[i] : i;
+}
+
+/**
+ * @brief Muda a numeração dos vértices (ver g_permute()): os vértices são
+ *	realocados pela nova ordem, já com as suas novas listas.
+ *
+ * @param g Ponteiro para grafo.
+ * @param order Nova ordem dos vértices.
+ * @param adj Nova lista de adjacências de cada posição.
+ */
+static void g_renumber(Graph *g, const unsigned short *order, Edge **adj)
+{
+	unsigned short n = g->free;
+	Vertex **vertices = (Vertex **) emalloc(g->size * sizeof(Vertex *));
+	unsigned short *orig = (unsigned short *) emalloc((n + 1) * sizeof(unsigned short));
+	unsigned short *rank = (unsigned short *) emalloc((n + 1) * sizeof(unsigned short));
+	unsigned short k;
+
+	for (k = 0; k < n; k++) {
+		vertices[k] = v_init(g->vértices[order[k]]->item);
+		vertices[k]->adj = adj[k];
+		orig[k] = g_get_orig(g, order[k]);
+		rank[orig[k]] = k;
+	}
+	for (k = 0; k < n; k++) {
+		free(g->vértices[k]);
+	}
+	free(g->vértices);
+	g->vértices = vertices;
+
+	free(g->orig);
+	free(g->rank);
+	g->orig = orig;
+	g->rank = rank;
+}
+
+/**
+ * @brief Renumera os vértices do grafo e refaz as listas de adjacências.
+ * @details O vértice de índice atual order[k] passa a ter o índice k. Os
+ *	vértices e as arestas são realocados pela nova ordem, para que
+ *	vértices com índices próximos fiquem próximos em memória.
+ *
+ *	Cada lista de adjacências fica pela ordem decrescente dos índices
+ *	originais dos vizinhos, que é a que g_make_edges() dá sem renumeração:
+ *	as pesquisas fazem as mesmas operações, pela mesma ordem, e encontram
+ *	os mesmos caminhos. Depois de reconstruir as arestas de um grafo já
+ *	renumerado, chamar com order NULL repõe essa ordem.
+ *
+ *	As tabelas associadas ao grafo (marcos, hierarquias) não são
+ *	alteradas.
+ *
+ * @param g Ponteiro para grafo.
+ * @param order Nova ordem dos vértices, ou NULL para manter a numeração.
+ */
+void g_permute(Graph *g, const unsigned short *order)
+{
+	unsigned short n = g->free;
+	unsigned short *pos = (unsigned short *) emalloc((n + 1) * sizeof(unsigned short));
+	unsigned long *start = (unsigned long *) ecalloc(n + 1, sizeof(unsigned long));
+	unsigned short *index = (unsigned short *) emalloc((2 * g->edges + 1) * sizeof(unsigned short));
+	unsigned short *weight = (unsigned short *) emalloc((2 * g->edges + 1) * sizeof(unsigned short));
+	Edge **adj = (Edge **) ecalloc(n + 1, sizeof(Edge *));
+	unsigned short i, k, u;
+	unsigned long j;
+	Edge *l;
+
+	for (k = 0; k < n; k++) {
+		pos[order != NULL ? order[k] : k] = k;
+	}
+
+	/* Segmento de cada vértice (nova numeração) nas tabelas de arestas. */
+	for (u = 0; u < n; u++) {
+		for (l = g->vértices[u]->adj; l != NULL; l = l->next) {
+			start[pos[u] + 1]++;
+		}
+	}
+	for (k = 0; k < n; k++) {
+		start[k + 1] += start[k];
+	}
+
+	/* Percorrendo as origens pela ordem original, cada segmento fica
+	 * pela ordem crescente dos índices originais dos vizinhos. */
+	for (i = 0; i < n; i++) {
+		u = g_get_index(g, i);
+		for (l = g->vértices[u]->adj; l != NULL; l = l->next) {
+			k = pos[l->index];
+			index[start[k]] = pos[u];
+			weight[start[k]] = l->weight;
+			start[k]++;
+		}
+	}
+
+	/* Novas listas pela nova ordem, alocadas antes de libertar as antigas
+	 * para que fiquem seguidas em memória; a inserção à cabeça inverte
+	 * cada segmento. Os segmentos avançaram até ao início do seguinte. */
+	for (k = 0; k < n; k++) {
+		for (j = k > 0 ? start[k - 1] : 0; j < start[k]; j++) {
+			e_insert(&adj[k], index[j], weight[j]);
+		}
+	}
+	for (u = 0; u < n; u++) {
+		free_adj(g->vértices[u]->adj);
+		g->vértices[u]->adj = NULL;
+	}
+
+	if (order == NULL) {
+		/* Mesma numeração: os vértices e as tabelas de índices, que as
+		 * pesquisas leem sem acesso exclusivo, não mudam. */
+		for (k = 0; k < n; k++) {
+			g->vértices[k]->adj = adj[k];
+		}
+	}
+	else {
+		g_renumber(g, order, adj);
+	}
+
+	free(adj);
+	free(pos);
+	free(start);
+	free(index);
+	free(weight);
+}
+
+/**
+ * @brief Comprime as listas de adjacências do grafo (ver packed.h) e
+ *	liberta as listas ligadas.
+ * @details As pesquisas percorrem as listas com pk_begin() e pk_next(),
+ *	pela mesma ordem. As funções que mudam as listas (g_permute(),
+ *	e_add()) só podem ser usadas depois de g_clear_edges(), que liberta
+ *	as listas comprimidas.
+ *
+ * @param g Ponteiro para grafo.
+ */
+void g_pack(Graph *g)
+{
+	unsigned short i;
+
+	g->packed = pk_build(g);
+	for (i = 0; i < g->free; i++) {
+		free_adj(g->vértices[i]->adj);
+		g->vértices[i]->adj = NULL;
+	}
+}
+
+/**
+ * @brief Função assessora das listas de adjacências comprimidas do grafo.
+ *
+ * @param g Ponteiro para grafo.
+ * @return Listas comprimidas, NULL se as listas não estiverem comprimidas.
+ */
+Packed *g_get_packed(Graph *g)
+{
+	return g->packed;
+}
+
+/**
+ * @brief Função assessora das tabelas de marcos do grafo.
+ *
+ * @param g Ponteiro para grafo.
+ * @return Lista de tabelas de marcos, NULL se ainda não existir nenhuma.
+ */
+Landmarks *g_get_landmarks(Graph *g)
+{
+	return g->landmarks;
+}
+
+/**
+ * @brief Associa ao grafo uma lista de tabelas de marcos.
+ * @details O grafo não é dono das tabelas: estas são libertadas por quem as
+ *	criou (ver lm_free()).
+ *
+ * @param g Ponteiro para grafo.
+ * @param lm Lista de tabelas de marcos.
+ */
+void g_set_landmarks(Graph *g, Landmarks *lm)
+{
+	g->landmarks = lm;
+}
+
+/**
+ * @brief Função assessora das hierarquias de contração do grafo.
+ *
+ * @param g Ponteiro para grafo.
+ * @return Lista de hierarquias, NULL se ainda não existir nenhuma.
+ */
+Hierarchy *g_get_hierarchies(Graph *g)
+{
+	return g->hierarchies;
+}
+
+/**
+ * @brief Associa ao grafo uma lista de hierarquias de contração.
+ * @details Tal como as tabelas de marcos, são libertadas por quem as
+ *	criou (ver ch_free()).
+ *
+ * @param g Ponteiro para grafo.
+ * @param ch Lista de hierarquias.
+ */
+void g_set_hierarchies(Graph *g, Hierarchy *ch)
+{
+	g->hierarchies = ch;
+}
+
 
 /**
  * @brief Inicializar um vértice com item i.
@@ -270,6 +596,7 @@ void e_add(Graph *g, unsigned short i1, unsigned short i2, unsigned short weight
 {
 	e_insert(&(g->vértices[i1]->adj), i2, weight);
 	e_insert(&(g->vértices[i2]->adj), i1, weight);
+	g->edges++;
 }
 
 /**
@@ -11,22 +11,44 @@
 #ifndef _GRAPH_H
 #define _GRAPH_H
 
+#include <stddef.h>
+
 #include "bool.h"
 #include "item.h"
 
 typedef struct _Vertex Vertex;
 typedef struct _Edge Edge;
 typedef struct _Graph Graph;
+/* Tabelas de marcos (ALT) associadas a um grafo, ver landmark.h. */
+typedef struct _Landmarks Landmarks;
+/* Hierarquias de contração associadas a um grafo, ver ch.h. */
+typedef struct _Hierarchy Hierarchy;
+/* Listas de adjacências comprimidas de um grafo, ver packed.h. */
+typedef struct _Packed Packed;
 
 Graph *g_init(unsigned short size, unsigned short max_weight);
 void g_free(Graph *g, void (free_item)(Item item));
 void g_insert(Graph *g, Item i);
 void g_make_edges(Graph *g, unsigned short (*calc_weight)(Item i1, Item i2, unsigned short max));
+void g_clear_edges(Graph *g, unsigned short max_weight);
 unsigned short g_get_size(Graph *g);
 unsigned short g_get_free(Graph *g);
 unsigned short g_get_max_weight(Graph *g);
+void g_set_max_weight(Graph *g, unsigned short max_weight);
+unsigned long g_get_edges(Graph *g);
+size_t g_get_bytes(Graph *g);
 Vertex *g_get_vertex(Graph *g, unsigned short i);
 int g_find_vertex(Graph *g, Item i1, int (*cmp_item)(Item c1, Item c2));
+bool g_is_permuted(Graph *g);
+unsigned short g_get_orig(Graph *g, unsigned short v);
+unsigned short g_get_index(Graph *g, unsigned short i);
+void g_permute(Graph *g, const unsigned short *order);
+void g_pack(Graph *g);
+Packed *g_get_packed(Graph *g);
+Landmarks *g_get_landmarks(Graph *g);
+void g_set_landmarks(Graph *g, Landmarks *lm);
+Hierarchy *g_get_hierarchies(Graph *g);
+void g_set_hierarchies(Graph *g, Hierarchy *ch);
 
 
 Vertex *v_init(Item i);
@@ -222,3 +222,56 @@ bool h_empty(Heap *h)
 {
 	return !(h->free);
 }
+
+/**
+ * @brief Esvazia a heap, sem a libertar.
+ * @details A hash table não precisa de ser limpa: cada posição é escrita
+ * quando o elemento correspondente é inserido.
+ *
+ * @param h Ponteiro para heap.
+ */
+void h_clear(Heap *h)
+{
+	h->free = 0;
+}
+
+/**
+ * @brief Número de elementos na heap.
+ *
+ * @param h Ponteiro para heap.
+ * @return Número de elementos.
+ */
+unsigned short h_count(Heap *h)
+{
+	return h->free;
+}
+
+/**
+ * @brief Elemento numa posição do vetor da heap.
+ * @details Com h_count() permite guardar a heap tal como está, para a
+ *	refazer mais tarde com h_append() (ver sp_cached()).
+ *
+ * @param h Ponteiro para heap.
+ * @param i Posição, menor que h_count(h).
+ * @return Elemento.
+ */
+Item h_get(Heap *h, unsigned short i)
+{
+	return h->vector[i];
+}
+
+/**
+ * @brief Acrescenta um elemento no fim do vetor da heap, sem o pôr no sítio.
+ * @details Só serve para refazer uma heap guardada com h_get(), pela mesma
+ *	ordem e com as mesmas prioridades: a heap fica exatamente como estava.
+ *
+ * @param h Ponteiro para heap.
+ * @param a Elemento.
+ * @param hash Função de dispersão dos elementos.
+ */
+void h_append(Heap *h, Item a, unsigned short (*hash)(Item))
+{
+	h->vector[h->free] = a;
+	h->hash_table[hash(a)] = h->free;
+	h->free++;
+}
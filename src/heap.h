@@ -31,5 +31,9 @@ void h_inc_pri(Heap *h, Item a, bool (*less_pri)(Item, Item), unsigned short (*h
 
 void h_exch(Heap *h, unsigned short i1, unsigned short i2, unsigned short (*hash)(Item));
 bool h_empty(Heap *h);
+void h_clear(Heap *h);
+unsigned short h_count(Heap *h);
+Item h_get(Heap *h, unsigned short i);
+void h_append(Heap *h, Item a, unsigned short (*hash)(Item));
 
 #endif
@@ -0,0 +1,256 @@
+/**
+ * @file heapgen.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Gerador de acervos d-ários indexados especializados.
+ * @details
+ *	HEAP_GENERATE(p, Name, Key, LESS, ARITY) define o tipo Name, um acervo
+ *	de valores inteiros (0 a size - 1, por exemplo vértices) com chaves do
+ *	tipo Key, em que LESS(a, b) diz se a chave a sai antes da chave b, com
+ *	ARITY filhos por nó. As funções são static (e inline com gcc) e
+ *	chamam LESS diretamente, pelo que o compilador as pode expandir no
+ *	ciclo de quem as usa, ao contrário das de heap.c, que comparam através
+ *	de ponteiros para funções.
+ *
+ *	Os pares (chave, valor) estão no próprio vetor do acervo e a posição de
+ *	cada valor numa tabela. O vetor é alinhado de maneira que os filhos de
+ *	cada nó começam numa fronteira de ARITY pares (com 4 pares de 8 bytes,
+ *	ficam na mesma linha de cache). fixup e fixdown abrem um buraco que
+ *	sobe ou desce e só escrevem o elemento no fim.
+ *
+ *	Funções geradas, com prefixo p:
+ *	p_init(size), p_free(h), p_clear(h), p_empty(h), p_count(h),
+ *	p_insert(h, v, key) (v não pode estar no acervo),
+ *	p_decrease(h, v, key) (v está no acervo e key não é maior que a sua),
+ *	p_key(h, v) (chave de v, que está no acervo),
+ *	p_pop(h) (retira e devolve o valor de menor chave),
+ *	p_value(h, i) e p_append(h, v, key) (guardar o vetor tal como está,
+ *	por ordem, e refazê-lo exatamente igual).
+ *
+ *	LAZY_HEAP_GENERATE(p, Name, Key, LESS, ARITY) define um acervo sem
+ *	tabela de posições, que aceita o mesmo valor várias vezes: em vez de
+ *	diminuir a chave de um valor, insere-se outra cópia, e quem retira
+ *	descarta as cópias que já não interessam. O vetor cresce quando enche.
+ *	Funções geradas: p_init(size) (size é só a capacidade inicial),
+ *	p_free(h), p_clear(h), p_empty(h), p_count(h), p_push(h, v, key) e
+ *	p_pop(h).
+ */
+#ifndef _HEAPGEN_H
+#define _HEAPGEN_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bool.h"
+#include "inline.h"
+#include "utils.h"
+
+/* Tamanho de uma linha de cache, em bytes. */
+#define HG_CACHE_LINE 64
+
+/* Posição dos pares no bloco alocado: o filho 1 da raiz (e portanto os
+ * filhos de cada nó) começa numa linha de cache. */
+#define HG_NODES(block, Node, ARITY)                                          \
+	((Node *) (((size_t) (block) + HG_CACHE_LINE - 1)                     \
+		& ~((size_t) HG_CACHE_LINE - 1)) + (ARITY) - 1)
+
+/* Bytes a alocar para n pares, com espaço para o alinhamento. */
+#define HG_BLOCK_BYTES(n, Node, ARITY)                                        \
+	(((n) + (ARITY)) * sizeof(Node) + HG_CACHE_LINE)
+
+/* Registo da posição de um valor, nos acervos indexados. */
+#define HG_SET_POS(h, v, i) ((h)->pos[v] = (i))
+#define HG_NO_POS(h, v, i) ((void) 0)
+
+/* fixup e fixdown, comuns aos dois tipos de acervo. */
+#define HG_SIFT(p, Name, LESS, ARITY, SET_POS)                                \
+                                                                              \
+STATIC_INLINE void p##_fixup(Name *h, int i, Name##Node n)                    \
+{                                                                             \
+	Name##Node *nodes = h->nodes;                                         \
+	int parent;                                                           \
+                                                                              \
+	while (i > 0 && LESS(n.key, nodes[parent = (i - 1) / (ARITY)].key)) { \
+		nodes[i] = nodes[parent];                                     \
+		SET_POS(h, nodes[i].value, i);                                \
+		i = parent;                                                   \
+	}                                                                     \
+	nodes[i] = n;                                                         \
+	SET_POS(h, n.value, i);                                               \
+}                                                                             \
+                                                                              \
+STATIC_INLINE void p##_fixdown(Name *h, int i, Name##Node n)                  \
+{                                                                             \
+	Name##Node *nodes = h->nodes;                                         \
+	int child, last, best, k;                                             \
+                                                                              \
+	while ((child = (ARITY) * i + 1) < h->count) {                        \
+		last = child + (ARITY) < h->count ? child + (ARITY) : h->count; \
+		best = child;                                                 \
+		for (k = child + 1; k < last; k++) {                          \
+			if (LESS(nodes[k].key, nodes[best].key)) {            \
+				best = k;                                     \
+			}                                                     \
+		}                                                             \
+		if (!LESS(nodes[best].key, n.key)) {                          \
+			break;                                                \
+		}                                                             \
+		nodes[i] = nodes[best];                                       \
+		SET_POS(h, nodes[i].value, i);                                \
+		i = best;                                                     \
+	}                                                                     \
+	nodes[i] = n;                                                         \
+	SET_POS(h, n.value, i);                                               \
+}                                                                             \
+                                                                              \
+STATIC_INLINE void p##_clear(Name *h)                                         \
+{                                                                             \
+	h->count = 0;                                                         \
+}                                                                             \
+                                                                              \
+STATIC_INLINE bool p##_empty(Name *h)                                         \
+{                                                                             \
+	return h->count == 0;                                                 \
+}                                                                             \
+                                                                              \
+STATIC_INLINE int p##_count(Name *h)                                          \
+{                                                                             \
+	return h->count;                                                      \
+}                                                                             \
+                                                                              \
+STATIC_INLINE int p##_pop(Name *h)                                            \
+{                                                                             \
+	int v = h->nodes[0].value;                                            \
+                                                                              \
+	if (--h->count > 0) {                                                 \
+		p##_fixdown(h, 0, h->nodes[h->count]);                        \
+	}                                                                     \
+	return v;                                                             \
+}
+
+#define HEAP_GENERATE(p, Name, Key, LESS, ARITY)                              \
+                                                                              \
+typedef struct {                                                              \
+	Key key;                                                              \
+	int value;                                                            \
+} Name##Node;                                                                 \
+                                                                              \
+typedef struct {                                                              \
+	Name##Node *nodes;                                                    \
+	int *pos;                                                             \
+	int count;                                                            \
+	void *block;                                                          \
+} Name;                                                                       \
+                                                                              \
+HG_SIFT(p, Name, LESS, ARITY, HG_SET_POS)                                     \
+                                                                              \
+STATIC_INLINE Name *p##_init(int size)                                        \
+{                                                                             \
+	Name *h = (Name *) emalloc(sizeof(Name));                             \
+                                                                              \
+	h->block = emalloc(HG_BLOCK_BYTES(size, Name##Node, ARITY));          \
+	h->nodes = HG_NODES(h->block, Name##Node, ARITY);                     \
+	h->pos = (int *) emalloc((size > 0 ? size : 1) * sizeof(int));        \
+	h->count = 0;                                                         \
+	return h;                                                             \
+}                                                                             \
+                                                                              \
+STATIC_INLINE void p##_free(Name *h)                                          \
+{                                                                             \
+	free(h->block);                                                       \
+	free(h->pos);                                                         \
+	free(h);                                                              \
+}                                                                             \
+                                                                              \
+STATIC_INLINE void p##_insert(Name *h, int v, Key key)                        \
+{                                                                             \
+	Name##Node n;                                                         \
+                                                                              \
+	n.key = key;                                                          \
+	n.value = v;                                                          \
+	p##_fixup(h, h->count++, n);                                          \
+}                                                                             \
+                                                                              \
+STATIC_INLINE void p##_decrease(Name *h, int v, Key key)                      \
+{                                                                             \
+	Name##Node n;                                                         \
+                                                                              \
+	n.key = key;                                                          \
+	n.value = v;                                                          \
+	p##_fixup(h, h->pos[v], n);                                           \
+}                                                                             \
+                                                                              \
+STATIC_INLINE Key p##_key(Name *h, int v)                                     \
+{                                                                             \
+	return h->nodes[h->pos[v]].key;                                       \
+}                                                                             \
+                                                                              \
+STATIC_INLINE int p##_value(Name *h, int i)                                   \
+{                                                                             \
+	return h->nodes[i].value;                                             \
+}                                                                             \
+                                                                              \
+STATIC_INLINE void p##_append(Name *h, int v, Key key)                        \
+{                                                                             \
+	h->nodes[h->count].key = key;                                         \
+	h->nodes[h->count].value = v;                                         \
+	h->pos[v] = h->count++;                                               \
+}
+
+#define LAZY_HEAP_GENERATE(p, Name, Key, LESS, ARITY)                         \
+                                                                              \
+typedef struct {                                                              \
+	Key key;                                                              \
+	int value;                                                            \
+} Name##Node;                                                                 \
+                                                                              \
+typedef struct {                                                              \
+	Name##Node *nodes;                                                    \
+	int count;                                                            \
+	int max;                                                              \
+	void *block;                                                          \
+} Name;                                                                       \
+                                                                              \
+HG_SIFT(p, Name, LESS, ARITY, HG_NO_POS)                                      \
+                                                                              \
+STATIC_INLINE Name *p##_init(int size)                                        \
+{                                                                             \
+	Name *h = (Name *) emalloc(sizeof(Name));                             \
+                                                                              \
+	h->max = size > 0 ? size : 1;                                         \
+	h->block = emalloc(HG_BLOCK_BYTES(h->max, Name##Node, ARITY));        \
+	h->nodes = HG_NODES(h->block, Name##Node, ARITY);                     \
+	h->count = 0;                                                         \
+	return h;                                                             \
+}                                                                             \
+                                                                              \
+STATIC_INLINE void p##_free(Name *h)                                          \
+{                                                                             \
+	free(h->block);                                                       \
+	free(h);                                                              \
+}                                                                             \
+                                                                              \
+STATIC_INLINE void p##_push(Name *h, int v, Key key)                          \
+{                                                                             \
+	Name##Node n;                                                         \
+	void *block;                                                          \
+	Name##Node *nodes;                                                    \
+                                                                              \
+	if (h->count == h->max) {                                             \
+		/* O alinhamento muda de bloco para bloco: não serve realloc. */ \
+		block = emalloc(HG_BLOCK_BYTES(2 * h->max, Name##Node, ARITY)); \
+		nodes = HG_NODES(block, Name##Node, ARITY);                   \
+		memcpy(nodes, h->nodes, h->count * sizeof(Name##Node));       \
+		free(h->block);                                               \
+		h->block = block;                                             \
+		h->nodes = nodes;                                             \
+		h->max *= 2;                                                  \
+	}                                                                     \
+	n.key = key;                                                          \
+	n.value = v;                                                          \
+	p##_fixup(h, h->count++, n);                                          \
+}
+
+#endif
@@ -0,0 +1,19 @@
+/**
+ * @file inline.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Funções static inline nos cabeçalhos.
+ */
+#ifndef _INLINE_H
+#define _INLINE_H
+
+/* inline não existe em C89; o gcc aceita __inline__ em qualquer modo. */
+#if defined(__GNUC__)
+#define STATIC_INLINE static __inline__
+#else
+#define STATIC_INLINE static
+#endif
+
+#endif
@@ -0,0 +1,435 @@
+/**
+ * @file landmark.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Pré-processamento por marcos (ALT: A*, Landmarks, Triangle inequality).
+ * @details
+ *	Para cada grafo escolhem-se alguns vértices marco e guardam-se as
+ *	distâncias de cada marco a todos os vértices. Pela desigualdade
+ *	triangular, |d(L,t) - d(L,v)| é um limite inferior de d(v,t), que
+ *	serve de heurística admissível e consistente ao A* em shortest_path().
+ *
+ *	As distâncias dependem do peso máximo de arestas considerado, pelo que
+ *	cada tabela corresponde a um limiar; um grafo pode ter várias tabelas,
+ *	numa lista ordenada por limiar crescente.
+ *
+ *	Os empates na escolha dos marcos e os ficheiros usam a ordem original
+ *	dos vértices (ver g_permute()), para que as tabelas sejam as mesmas
+ *	com ou sem --renumber.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "landmark.h"
+#include "dijkstra.h"
+#include "packed.h"
+#include "graph.h"
+#include "utils.h"
+
+/**
+ * @brief Tabela de marcos de um grafo para um limiar de peso.
+ * @details max_weight: peso máximo das arestas usadas no cálculo das distâncias
+ *	n: número de marcos
+ *	size: número de vértices do grafo
+ *	marks: índices dos vértices marco
+ *	dist: distâncias dos marcos aos vértices; dist[v*n + i] é a distância
+ *	do marco i ao vértice v (MAX_WT se inalcançável). As distâncias de um
+ *	vértice estão contíguas, pois são lidas em conjunto por lm_bound().
+ *	next: próxima tabela do mesmo grafo (limiar maior)
+ */
+struct _Landmarks {
+	unsigned short max_weight;
+	int n;
+	int size;
+	int *marks;
+	int *dist;
+	struct _Landmarks *next;
+};
+
+/**
+ * @brief Escolhe o vértice de onde parte a seleção de marcos.
+ * @details O vértice com mais arestas admissíveis está, com grande
+ *	probabilidade, na maior componente conexa do grafo.
+ *
+ * @param g Ponteiro para grafo.
+ * @param max_weight Peso máximo de arestas a considerar.
+ * @return Índice do vértice de maior grau.
+ */
+static int lm_start_vertex(Graph *g, unsigned short max_weight)
+{
+	int i, v, deg;
+	int best = 0, best_deg = -1;
+	unsigned short index, weight;
+	PkIter l;
+
+	for (i = 0; i < g_get_size(g); i++) {
+		v = g_get_index(g, i);
+		deg = 0;
+		for (pk_begin(g, v, &l); pk_next(&l, &index, &weight); ) {
+			if (weight <= max_weight) {
+				deg++;
+			}
+		}
+		if (deg > best_deg) {
+			best_deg = deg;
+			best = v;
+		}
+	}
+
+	return best;
+}
+
+/**
+ * @brief Escolhe o vértice alcançável mais afastado de um conjunto.
+ *
+ * @param g Ponteiro para grafo.
+ * @param dist Distâncias ao conjunto (MAX_WT se inalcançável).
+ * @return Índice do vértice alcançável de maior distância.
+ */
+static int lm_farthest(Graph *g, int *dist)
+{
+	int i, v, best = g_get_index(g, 0);
+
+	for (i = 0; i < g_get_size(g); i++) {
+		v = g_get_index(g, i);
+		if (dist[v] != MAX_WT && (dist[best] == MAX_WT || dist[v] > dist[best])) {
+			best = v;
+		}
+	}
+
+	return best;
+}
+
+/**
+ * @brief Constrói uma tabela de marcos por seleção do ponto mais afastado.
+ * @details O primeiro marco é o vértice mais afastado do vértice de maior
+ *	grau; cada marco seguinte é o vértice cuja distância ao marco mais
+ *	próximo já escolhido é máxima. Só se consideram vértices alcançáveis,
+ *	para que não se gastem marcos em vértices isolados.
+ *
+ * @param g Ponteiro para grafo.
+ * @param max_weight Peso máximo de arestas a considerar.
+ * @param n Número de marcos pretendido (pode ser reduzido se a componente
+ *	for pequena).
+ * @return Tabela de marcos.
+ */
+Landmarks *lm_build(Graph *g, unsigned short max_weight, int n)
+{
+	Landmarks *lm;
+	int size = g_get_size(g);
+	SpScratch *sp; /* Tabelas de trabalho das pesquisas. */
+	int *st; /* Árvore de caminhos, não utilizada. */
+	int *wt; /* Distâncias devolvidas por shortest_path(). */
+	int *mind; /* Distância de cada vértice ao marco mais próximo. */
+	int i, v, cur;
+
+	lm = (Landmarks *) emalloc(sizeof(Landmarks));
+	lm->max_weight = max_weight;
+	lm->size = size;
+	lm->marks = (int *) emalloc(n * sizeof(int));
+	lm->dist = (int *) emalloc((size_t) n * size * sizeof(int));
+	lm->next = NULL;
+
+	sp = sp_scratch_init(SP_QUEUE_HEAP);
+	st = (int *) emalloc(size * sizeof(int));
+	mind = (int *) emalloc(size * sizeof(int));
+	for (v = 0; v < size; v++) {
+		mind[v] = MAX_WT;
+	}
+
+	wt = shortest_path(sp, g, lm_start_vertex(g, max_weight), -1, st, max_weight,
+			NULL, NULL, NULL);
+	cur = lm_farthest(g, wt);
+
+	for (i = 0; i < n; i++) {
+		lm->marks[i] = cur;
+		wt = shortest_path(sp, g, cur, -1, st, max_weight, NULL, NULL, NULL);
+		for (v = 0; v < size; v++) {
+			lm->dist[v*n + i] = wt[v];
+			if (wt[v] < mind[v]) {
+				mind[v] = wt[v];
+			}
+		}
+
+		cur = lm_farthest(g, mind);
+		/* Todos os vértices alcançáveis já são marcos. */
+		if (mind[cur] == 0) {
+			i++;
+			break;
+		}
+	}
+
+	/* Compactar a tabela se foram escolhidos menos marcos que o pedido. */
+	if (i < n) {
+		for (v = 0; v < size; v++) {
+			for (cur = 0; cur < i; cur++) {
+				lm->dist[v*i + cur] = lm->dist[v*n + cur];
+			}
+		}
+	}
+	lm->n = i;
+
+	sp_scratch_free(sp);
+	free(st);
+	free(mind);
+
+	return lm;
+}
+
+/**
+ * @brief Liberta uma lista de tabelas de marcos.
+ *
+ * @param list Lista de tabelas.
+ */
+void lm_free(Landmarks *list)
+{
+	Landmarks *tmp;
+
+	while (list) {
+		tmp = list->next;
+		free(list->marks);
+		free(list->dist);
+		free(list);
+		list = tmp;
+	}
+}
+
+/**
+ * @brief Insere uma tabela numa lista, mantendo a ordem crescente de limiar.
+ *
+ * @param list Lista de tabelas.
+ * @param lm Tabela a inserir.
+ * @return Nova cabeça da lista.
+ */
+Landmarks *lm_add(Landmarks *list, Landmarks *lm)
+{
+	Landmarks **p = &list;
+
+	while (*p != NULL && (*p)->max_weight < lm->max_weight) {
+		p = &((*p)->next);
+	}
+	lm->next = *p;
+	*p = lm;
+
+	return list;
+}
+
+/**
+ * @brief Escolhe a tabela a utilizar para um limiar de peso.
+ * @details As distâncias calculadas com um limiar maior nunca excedem as
+ *	distâncias com um limiar menor (há mais arestas), pelo que o limite
+ *	continua a ser admissível, embora menos apertado. Escolhe-se então a
+ *	tabela de menor limiar que não seja inferior ao pedido.
+ *
+ * @param list Lista de tabelas.
+ * @param max_weight Peso máximo de arestas da pesquisa.
+ * @return Tabela escolhida, ou NULL se nenhuma servir.
+ */
+Landmarks *lm_select(Landmarks *list, unsigned short max_weight)
+{
+	while (list != NULL && list->max_weight < max_weight) {
+		list = list->next;
+	}
+
+	return list;
+}
+
+/**
+ * @brief Limite inferior da distância entre dois vértices.
+ * @details max_i |d(L_i,t) - d(L_i,v)|. Se um marco alcança um dos vértices
+ *	e não o outro, estes estão em componentes diferentes.
+ *
+ * @param lm Tabela de marcos.
+ * @param v Índice do vértice.
+ * @param t Índice do vértice de destino.
+ * @return Limite inferior de d(v,t), ou MAX_WT se t for inalcançável de v.
+ */
+int lm_bound(Landmarks *lm, int v, int t)
+{
+	int *dv = lm->dist + v * lm->n;
+	int *dt = lm->dist + t * lm->n;
+	int i, d, best = 0;
+
+	for (i = 0; i < lm->n; i++) {
+		if (dv[i] == MAX_WT || dt[i] == MAX_WT) {
+			if (dv[i] != dt[i]) {
+				return MAX_WT;
+			}
+			continue;
+		}
+		d = dv[i] - dt[i];
+		if (d < 0) {
+			d = -d;
+		}
+		if (d > best) {
+			best = d;
+		}
+	}
+
+	return best;
+}
+
+/**
+ * @brief Renumera os vértices de uma lista de tabelas, como g_permute().
+ *
+ * @param list Lista de tabelas.
+ * @param order Nova ordem dos vértices (ver g_permute()).
+ */
+void lm_permute(Landmarks *list, const unsigned short *order)
+{
+	int *dist, *pos;
+	int v, i;
+
+	for (; list != NULL; list = list->next) {
+		pos = (int *) emalloc(list->size * sizeof(int));
+		dist = (int *) emalloc((size_t) list->n * list->size * sizeof(int));
+		for (v = 0; v < list->size; v++) {
+			pos[order[v]] = v;
+			memcpy(dist + v * list->n, list->dist + order[v] * list->n,
+					list->n * sizeof(int));
+		}
+		for (i = 0; i < list->n; i++) {
+			list->marks[i] = pos[list->marks[i]];
+		}
+		free(list->dist);
+		list->dist = dist;
+		free(pos);
+	}
+}
+
+/**
+ * @brief Assinatura dos vértices de um grafo.
+ * @details Permite verificar que tabelas guardadas em disco correspondem
+ *	ao mesmo grafo (mesmos vértices, pela mesma ordem original).
+ *
+ * @param g Ponteiro para grafo.
+ * @param hash_item Função de dispersão dos items dos vértices.
+ * @return Assinatura.
+ */
+static unsigned long lm_checksum(Graph *g, unsigned long (*hash_item)(Item))
+{
+	unsigned long h = g_get_size(g);
+	int v;
+
+	for (v = 0; v < g_get_size(g); v++) {
+		h = h * 31 + hash_item(v_get_item(g_get_vertex(g, g_get_index(g, v))));
+	}
+
+	return h;
+}
+
+/**
+ * @brief Escreve as tabelas de marcos de um grafo em formato binário.
+ * @details Formato: size, assinatura, número de tabelas e, por tabela,
+ *	max_weight, n, marks[n] e dist[n*size], com os vértices pela ordem
+ *	original.
+ *
+ * @param f Ficheiro de saída (binário).
+ * @param g Ponteiro para grafo.
+ * @param hash_item Função de dispersão dos items dos vértices.
+ */
+void lm_write(FILE *f, Graph *g, unsigned long (*hash_item)(Item))
+{
+	Landmarks *lm;
+	int size = g_get_size(g);
+	unsigned long checksum = lm_checksum(g, hash_item);
+	int count = 0;
+	int i, mark;
+
+	for (lm = g_get_landmarks(g); lm != NULL; lm = lm->next) {
+		count++;
+	}
+
+	fwrite(&size, sizeof(int), 1, f);
+	fwrite(&checksum, sizeof(unsigned long), 1, f);
+	fwrite(&count, sizeof(int), 1, f);
+
+	for (lm = g_get_landmarks(g); lm != NULL; lm = lm->next) {
+		fwrite(&lm->max_weight, sizeof(unsigned short), 1, f);
+		fwrite(&lm->n, sizeof(int), 1, f);
+		for (i = 0; i < lm->n; i++) {
+			mark = g_get_orig(g, lm->marks[i]);
+			fwrite(&mark, sizeof(int), 1, f);
+		}
+		for (i = 0; i < size; i++) {
+			fwrite(lm->dist + g_get_index(g, i) * lm->n, sizeof(int), lm->n, f);
+		}
+	}
+}
+
+/**
+ * @brief Lê as tabelas de marcos de um grafo escritas por lm_write().
+ * @details Se o grafo não corresponder ao das tabelas (tamanho ou
+ *	assinatura diferentes), estas são lidas e descartadas. As tabelas
+ *	cujo limiar o grafo já tem também são descartadas.
+ *
+ * @param f Ficheiro de entrada (binário).
+ * @param g Ponteiro para grafo, ou NULL para apenas descartar as tabelas.
+ * @param hash_item Função de dispersão dos items dos vértices.
+ * @return 1 se as tabelas foram associadas ao grafo, 0 se foram
+ *	descartadas, -1 se o ficheiro estiver mal formado.
+ */
+int lm_read(FILE *f, Graph *g, unsigned long (*hash_item)(Item))
+{
+	Landmarks *lm, *old;
+	int size, count, i, v;
+	unsigned long checksum;
+	unsigned short *order;
+	bool match;
+
+	if (fread(&size, sizeof(int), 1, f) != 1
+			|| fread(&checksum, sizeof(unsigned long), 1, f) != 1
+			|| fread(&count, sizeof(int), 1, f) != 1
+			|| size < 0 || count < 0) {
+		return -1;
+	}
+
+	match = (g != NULL && size == g_get_size(g)
+			&& checksum == lm_checksum(g, hash_item));
+
+	for (i = 0; i < count; i++) {
+		lm = (Landmarks *) emalloc(sizeof(Landmarks));
+		lm->size = size;
+		lm->next = NULL;
+		lm->marks = NULL;
+		lm->dist = NULL;
+		if (fread(&lm->max_weight, sizeof(unsigned short), 1, f) != 1
+				|| fread(&lm->n, sizeof(int), 1, f) != 1 || lm->n < 0) {
+			lm_free(lm);
+			return -1;
+		}
+		lm->marks = (int *) emalloc(lm->n * sizeof(int));
+		lm->dist = (int *) emalloc((size_t) lm->n * size * sizeof(int));
+		if (fread(lm->marks, sizeof(int), lm->n, f) != (size_t) lm->n
+				|| fread(lm->dist, sizeof(int), (size_t) lm->n * size, f)
+					!= (size_t) lm->n * size) {
+			lm_free(lm);
+			return -1;
+		}
+
+		if (!match) {
+			lm_free(lm);
+			continue;
+		}
+		/* O ficheiro está pela ordem original. */
+		if (g_is_permuted(g)) {
+			order = (unsigned short *) emalloc(size * sizeof(unsigned short));
+			for (v = 0; v < size; v++) {
+				order[v] = g_get_orig(g, v);
+			}
+			lm_permute(lm, order);
+			free(order);
+		}
+		old = lm_select(g_get_landmarks(g), lm->max_weight);
+		if (old != NULL && old->max_weight == lm->max_weight) {
+			lm_free(lm);
+			continue;
+		}
+		g_set_landmarks(g, lm_add(g_get_landmarks(g), lm));
+	}
+
+	return match;
+}
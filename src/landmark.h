@@ -0,0 +1,37 @@
+/**
+ * @file landmark.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Pré-processamento por marcos (ALT: A*, Landmarks, Triangle inequality).
+ * @details
+ *	Para cada grafo escolhem-se alguns vértices marco e guardam-se as
+ *	distâncias de cada marco a todos os vértices. Pela desigualdade
+ *	triangular, |d(L,t) - d(L,v)| é um limite inferior de d(v,t), que
+ *	serve de heurística admissível e consistente ao A* em shortest_path().
+ *
+ *	As distâncias dependem do peso máximo de arestas considerado, pelo que
+ *	cada tabela corresponde a um limiar; um grafo pode ter várias tabelas,
+ *	numa lista ordenada por limiar crescente.
+ */
+#ifndef _LANDMARK_H
+#define _LANDMARK_H
+
+#include <stdio.h>
+
+#include "graph.h"
+#include "item.h"
+
+Landmarks *lm_build(Graph *g, unsigned short max_weight, int n);
+void lm_free(Landmarks *list);
+
+Landmarks *lm_add(Landmarks *list, Landmarks *lm);
+Landmarks *lm_select(Landmarks *list, unsigned short max_weight);
+int lm_bound(Landmarks *lm, int v, int t);
+void lm_permute(Landmarks *list, const unsigned short *order);
+
+void lm_write(FILE *f, Graph *g, unsigned long (*hash_item)(Item));
+int lm_read(FILE *f, Graph *g, unsigned long (*hash_item)(Item));
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ * @file lock.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Acesso aos grafos partilhados por vários fios de execução.
+ * @details
+ *	Cada tamanho de palavra tem um trinco de leitura/escrita: as pesquisas
+ *	leem o grafo em conjunto, e a criação do grafo, das arestas e do
+ *	pré-processamento escreve-o sozinha. As construções (e a libertação de
+ *	grafos) são ainda feitas uma de cada vez, pois releem o dicionário e
+ *	registam fases nas estatísticas. As estatísticas dos problemas e a
+ *	cache de resultados têm um trinco à parte.
+ */
+/* Fios de execução são POSIX, não fazem parte de C89. */
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+
+#include "lock.h"
+#include "const.h"
+
+static pthread_rwlock_t graph_lock[MAX_WORD_SIZE];
+static pthread_mutex_t build_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Cria os trincos dos grafos, antes de criar os fios de execução.
+ */
+void lk_init(void)
+{
+	int i;
+
+	for (i = 0; i < MAX_WORD_SIZE; i++) {
+		pthread_rwlock_init(&graph_lock[i], NULL);
+	}
+}
+
+/**
+ * @brief Destrói os trincos dos grafos, depois de esperar pelos fios.
+ */
+void lk_destroy(void)
+{
+	int i;
+
+	for (i = 0; i < MAX_WORD_SIZE; i++) {
+		pthread_rwlock_destroy(&graph_lock[i]);
+	}
+}
+
+/**
+ * @brief Obtém o acesso a um grafo (ver Solver em file.h).
+ *
+ * @param size Tamanho de palavra do grafo, 0 para as estatísticas.
+ * @param exclusive Verdadeiro para construir, falso para pesquisar.
+ */
+void lk_lock(int size, bool exclusive)
+{
+	if (size == 0) {
+		pthread_mutex_lock(&stats_lock);
+	}
+	else if (exclusive) {
+		pthread_mutex_lock(&build_lock);
+		pthread_rwlock_wrlock(&graph_lock[size]);
+	}
+	else {
+		pthread_rwlock_rdlock(&graph_lock[size]);
+	}
+}
+
+/**
+ * @brief Liberta o acesso obtido por lk_lock().
+ *
+ * @param size Tamanho de palavra do grafo, 0 para as estatísticas.
+ * @param exclusive O mesmo valor passado a lk_lock().
+ */
+void lk_unlock(int size, bool exclusive)
+{
+	if (size == 0) {
+		pthread_mutex_unlock(&stats_lock);
+	}
+	else if (exclusive) {
+		pthread_rwlock_unlock(&graph_lock[size]);
+		pthread_mutex_unlock(&build_lock);
+	}
+	else {
+		pthread_rwlock_unlock(&graph_lock[size]);
+	}
+}
@@ -0,0 +1,22 @@
+/**
+ * @file lock.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Acesso aos grafos partilhados por vários fios de execução.
+ * @details
+ *	lk_lock() e lk_unlock() são as funções de acesso de um Solver (ver
+ *	file.h) usadas pelos modos com vários fios (daemon e --pipeline).
+ */
+#ifndef _LOCK_H
+#define _LOCK_H
+
+#include "bool.h"
+
+void lk_init(void);
+void lk_destroy(void);
+void lk_lock(int size, bool exclusive);
+void lk_unlock(int size, bool exclusive);
+
+#endif
@@ -15,6 +15,13 @@
 #include "const.h"
 #include "file.h"
 #include "word.h"
+#include "options.h"
+#include "landmark.h"
+#include "ch.h"
+#include "stats.h"
+#include "daemon.h"
+#include "result.h"
+#include "binio.h"
 
 /* Strings constantes que dão as extensões válidas dos ficheiros de entrada. */
 static const char *VALID_EXTS[] = {".dic", ".pal"};
@@ -32,10 +39,87 @@ void free_memory(Graph **graphs)
 
 	for (i = 0; i < MAX_WORD_SIZE; i++) {
 		if (graphs[i] != NULL) {
+			lm_free(g_get_landmarks(graphs[i]));
+			ch_free(g_get_hierarchies(graphs[i]));
 			g_free(graphs[i], w_free);
 		}
 	}
 	free(graphs);
+	rc_free();
+}
+
+/**
+ * @brief Modos servidor e daemon: lê o dicionário uma vez e resolve os
+ *	problemas que chegam pelo stdin até ao fim do ficheiro (--server) ou
+ *	por ligações a uma socket Unix até receber SIGINT/SIGTERM (--socket).
+ * @details Os grafos ficam em memória entre problemas; as arestas de cada
+ *	tamanho só são construídas quando aparece o primeiro problema que as
+ *	usa (e reconstruídas se aparecer um número de permutações maior).
+ *
+ * @param dic_name Nome do ficheiro de dicionário.
+ * @return Código de saída do programa.
+ */
+static int run_server(const char *dic_name)
+{
+	FILE *fdic;
+	Graph **graphs;
+	Solver *so;
+	char *test;
+	int status = EXIT_SUCCESS;
+
+	test = strrchr(dic_name, '.');
+	if (!test || strcmp(test, VALID_EXTS[0]) != 0) {
+		return EXIT_FAILURE;
+	}
+	/* As respostas do servidor são sempre em texto, uma por linha pedida. */
+	options.path_binary = 0;
+
+	fdic = efopen(dic_name, "r");
+	st_begin("read_dic");
+	graphs = read_dic(fdic);
+	st_end();
+
+	if (options.alt_file != NULL) {
+		st_begin("load_landmarks");
+		load_landmarks(options.alt_file, graphs);
+		st_end();
+	}
+	if (options.result_file != NULL) {
+		st_begin("load_results");
+		load_results(options.result_file);
+		st_end();
+	}
+
+	st_begin("serve");
+	if (options.socket_path != NULL) {
+		status = daemon_run(options.socket_path, graphs, options.workers);
+	}
+	else {
+		so = so_init(NULL, NULL);
+		serve(stdin, stdout, graphs, so);
+		so_free(so);
+	}
+	st_end();
+
+	if (options.alt_file != NULL && options.alt_landmarks > 0) {
+		st_begin("save_landmarks");
+		save_landmarks(options.alt_file, graphs);
+		st_end();
+	}
+	if (options.result_file != NULL) {
+		st_begin("save_results");
+		save_results(options.result_file);
+		st_end();
+	}
+
+	st_begin("free_memory");
+	free_memory(graphs);
+	st_end();
+	fclose(fdic);
+
+	st_report();
+
+	return status;
 }
 
 
@@ -47,49 +131,107 @@ int main(int argc, char **argv)
 	FILE *fdic, *fpal, *fpath;
 	char *fpath_name;
 	char *test;
-	unsigned short *max_perms;
+	const char *out_ext;
 	/* Array de grafos por tamanhos de palavras que contêm. */
 	Graph **graphs;
 	int i;
+	int first; /* Índice do primeiro argumento posicional. */
 
 	/* Verificação dos parâmetros de entrada*/
-	if (argc != 3) {
+	first = parse_options(argc, argv);
+	if (first >= 0 && (options.server || options.socket_path != NULL)
+			&& argc - first == 1) {
+		return run_server(argv[first]);
+	}
+	if (first < 0 || options.server || options.socket_path != NULL
+			|| argc - first != 2) {
+		usage(argv[0]);
 		return EXIT_FAILURE;
 	}
+	argv += first - 1;
 
-	/* Verificar extensões dos ficheiros */
+	/* Verificar extensões dos ficheiros; os problemas também podem vir
+	 * em binário, ou do stdin ("-", em texto ou binário, reconhecido pela
+	 * identificação), e então os caminhos vão para o stdout. */
 	for (i = 0; i < 2; i++) {
 		test = strrchr(argv[i+1], '.');
 
-		if (!test || strcmp(test, VALID_EXTS[i]) != 0) {
+		if (i == 1 && strcmp(argv[2], "-") == 0) {
+			options.pal_binary = -1;
+		}
+		else if (i == 1 && test && strcmp(test, BIN_PAL_EXT) == 0) {
+			options.pal_binary = 1;
+		}
+		else if (!test || strcmp(test, VALID_EXTS[i]) != 0) {
 			return EXIT_FAILURE;
 		}
 	}
+	if (options.path_binary < 0) {
+		options.path_binary = options.pal_binary > 0;
+	}
+	out_ext = options.path_binary ? BIN_PATH_EXT : OUT_EXT;
 
 	/* Abrir ficheiros (efopen faz exit() em caso de erro) */
 	fdic = efopen(argv[1], "r");
-	fpal = efopen(argv[2], "r");
-	fpath_name = change_file_ext(argv[2], OUT_EXT);
-	fpath = efopen(fpath_name, "w");
-	free(fpath_name);
-
-	/* Encontrar os tamanhos de palavras e o número máximo de permutações
-	 * para cada tamanho a partir do ficheiro de problemas. */
-	max_perms = find_max_perms(fpal);
-	rewind(fpal);
-
-	/* Ler o dicionário para obter os nós dos grafos. */
-	graphs = read_dic(fdic, max_perms);
-	fclose(fdic);
-	free(max_perms);
+	if (options.pal_binary < 0) {
+		fpal = stdin;
+		fpath = stdout;
+	}
+	else {
+		fpal = efopen(argv[2], "rb");
+		fpath_name = change_file_ext(argv[2], out_ext);
+		fpath = efopen(fpath_name, "wb");
+		free(fpath_name);
+	}
+	if (options.path_binary) {
+		bin_write_magic(fpath, PATH_MAGIC);
+	}
+
+	/* Contar as palavras do dicionário. Cada grafo só é construído no
+	 * primeiro problema que precisa dele. */
+	st_begin("read_dic");
+	graphs = read_dic(fdic);
+	st_end();
+
+	/* Tabelas de marcos de execuções anteriores. */
+	if (options.alt_file != NULL) {
+		st_begin("load_landmarks");
+		load_landmarks(options.alt_file, graphs);
+		st_end();
+	}
+	/* Resultados de execuções anteriores. */
+	if (options.result_file != NULL) {
+		st_begin("load_results");
+		load_results(options.result_file);
+		st_end();
+	}
 
 	/* Ler e resolver problemas. */
+	st_begin("solve_pal");
 	solve_pal(fpal, fpath, graphs);
 	fclose(fpal);
 	fclose(fpath);
+	st_end();
+
+	/* Guardar as tabelas de marcos, incluindo as construídas agora. */
+	if (options.alt_file != NULL && options.alt_landmarks > 0) {
+		st_begin("save_landmarks");
+		save_landmarks(options.alt_file, graphs);
+		st_end();
+	}
+	if (options.result_file != NULL) {
+		st_begin("save_results");
+		save_results(options.result_file);
+		st_end();
+	}
 
 	/* Libertar memória. */
+	st_begin("free_memory");
 	free_memory(graphs);
+	st_end();
+	fclose(fdic);
+
+	st_report();
 
 	return EXIT_SUCCESS;
 }
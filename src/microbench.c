@@ -0,0 +1,719 @@
+/**
+ * @file microbench.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Microbenchmarks das funções críticas do wordmorph.
+ * @details
+ *	Mede, em nanossegundos por operação, w_diff(), as operações da fila
+ *	prioritária (h_insert(), h_inc_pri(), h_del_max_pri(), e uma sequência
+ *	sintética ao estilo de Dijkstra) e g_make_edges(). Cada medida é
+ *	repetida várias vezes e são mostrados a mediana, o mínimo, a média e o
+ *	desvio padrão.
+ *
+ *	As palavras vêm de um dicionário (por omissão ../vrfy/portugues08.dic);
+ *	as chaves da fila são geradas por um gerador pseudo-aleatório de
+ *	semente fixa, para que as execuções sejam comparáveis.
+ *
+ *	Com --trace=F, as operações da fila das pesquisas de Dijkstra dos
+ *	problemas do .pal F são gravadas e depois reproduzidas em cada uma das
+ *	filas (heap.c e dheap.h), para as comparar com chaves reais.
+ *
+ *	Utilização: microbench [--reps=N] [--graph-words=N] [--trace=F.pal]
+ *	[dicionário.dic]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "const.h"
+#include "utils.h"
+#include "word.h"
+#include "heap.h"
+#include "dheap.h"
+#include "graph.h"
+
+/* Número máximo de repetições de cada medida. */
+#define MAX_REPS 100
+/* Número de pares de palavras comparados por repetição de w_diff(). */
+#define DIFF_PAIRS 1000000
+/* Número de items na fila (tem de caber em unsigned short). */
+#define HEAP_ITEMS 40000
+/* Vizinhos de cada vértice do grafo sintético da sequência de Dijkstra. */
+#define SYNTH_DEGREE 16
+/* Número máximo de problemas gravados de um .pal. */
+#define TRACE_PROBLEMS 1000
+
+/* Operações de um traço de Dijkstra (ver record_trace()). */
+#define OP_INSERT 0
+#define OP_DECREASE 1
+#define OP_POP 2
+#define OP_CLEAR 3
+
+/**
+ * @brief Operação de um traço: op, vértice e chave (OP_INSERT e
+ *	OP_DECREASE) ou vértice retirado (OP_POP).
+ */
+typedef struct _TraceOp {
+	int op;
+	int v;
+	int key;
+} TraceOp;
+
+static unsigned int seed = 12345;
+
+/* Chaves da fila, comparadas por mb_less_pri(). */
+static int *mb_key = NULL;
+
+/* Traço gravado por record_trace(), de um grafo de trace_size vértices. */
+static TraceOp *trace = NULL;
+static long trace_len = 0;
+static int trace_size = 0;
+
+/**
+ * @brief Gerador pseudo-aleatório (xorshift), de semente fixa.
+ *
+ * @return Próximo número da sequência.
+ */
+static unsigned int mb_rand(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+/**
+ * @brief Comparador da fila: menor chave tem maior prioridade.
+ */
+static bool mb_less_pri(Item a, Item b)
+{
+	return mb_key[*((int *) a)] > mb_key[*((int *) b)];
+}
+
+/**
+ * @brief Dispersão da fila: o item é o índice.
+ */
+static unsigned short mb_hash(Item a)
+{
+	return *((int *) a);
+}
+
+/**
+ * @brief Libertador de items que não liberta nada: as palavras são
+ *	partilhadas entre os grafos das várias repetições.
+ */
+static void mb_keep(Item item)
+{
+	(void) item;
+}
+
+/**
+ * @brief Comparador de doubles para qsort().
+ */
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *((const double *) a), y = *((const double *) b);
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Escreve a linha de resultados de uma medida.
+ *
+ * @param name Nome da medida.
+ * @param ns Nanossegundos por operação em cada repetição (é ordenada).
+ * @param reps Número de repetições.
+ * @param ops Número de operações por repetição.
+ */
+static void report(const char *name, double *ns, int reps, long ops)
+{
+	int i;
+	double mean = 0, var = 0;
+
+	qsort(ns, reps, sizeof(double), cmp_double);
+	for (i = 0; i < reps; i++) {
+		mean += ns[i];
+	}
+	mean /= reps;
+	for (i = 0; i < reps; i++) {
+		var += (ns[i] - mean) * (ns[i] - mean);
+	}
+	if (reps > 1) {
+		var /= reps - 1;
+	}
+
+	printf("%-24s %10ld %10.2f %10.2f %10.2f %10.2f\n", name, ops,
+		ns[reps / 2], ns[0], mean, sqrt(var));
+}
+
+/**
+ * @brief Lê as palavras de um dicionário.
+ *
+ * @param name Nome do ficheiro.
+ * @param count Onde escrever o número de palavras lidas.
+ * @return Tabela de palavras.
+ */
+static Item *read_words(const char *name, int *count)
+{
+	FILE *f = efopen(name, "r");
+	char buffer[MAX_WORD_SIZE];
+	Item *words = NULL;
+	int n = 0, max = 0;
+
+	while (fscanf(f, "%63s", buffer) == 1) {
+		if (n == max) {
+			max = max ? 2 * max : 1024;
+			words = erealloc(words, max * sizeof(Item));
+		}
+		words[n++] = w_new(buffer);
+	}
+	fclose(f);
+
+	*count = n;
+	return words;
+}
+
+/**
+ * @brief w_diff() sobre pares aleatórios de palavras do mesmo tamanho.
+ *
+ * @param words Palavras.
+ * @param n Número de palavras.
+ * @param max_perm Limite passado a w_diff() (controla a paragem antecipada).
+ * @param reps Repetições.
+ */
+static void bench_diff(Item *words, int n, unsigned short max_perm, int reps)
+{
+	int *a = (int *) emalloc(DIFF_PAIRS * sizeof(int));
+	int *b = (int *) emalloc(DIFF_PAIRS * sizeof(int));
+	double ns[MAX_REPS];
+	double start;
+	unsigned long sink = 0;
+	char name[32];
+	int r, i;
+
+	for (i = 0; i < DIFF_PAIRS; i++) {
+		a[i] = mb_rand() % n;
+		/* Só se comparam palavras do mesmo tamanho, como em g_make_edges(). */
+		do {
+			b[i] = mb_rand() % n;
+		} while (strlen(words[a[i]]) != strlen(words[b[i]]));
+	}
+
+	for (r = 0; r < reps; r++) {
+		start = mono_time();
+		for (i = 0; i < DIFF_PAIRS; i++) {
+			sink += w_diff(words[a[i]], words[b[i]], max_perm);
+		}
+		ns[r] = (mono_time() - start) * 1e9 / DIFF_PAIRS;
+	}
+
+	sprintf(name, "w_diff (max %hu)", max_perm);
+	report(name, ns, reps, DIFF_PAIRS);
+	/* Impede o compilador de eliminar o ciclo. */
+	if (sink == 1) {
+		printf("\n");
+	}
+
+	free(a);
+	free(b);
+}
+
+/**
+ * @brief h_insert(), h_inc_pri() e h_del_max_pri() isoladas.
+ * @details Cada repetição insere HEAP_ITEMS chaves aleatórias, reduz a
+ *	chave de HEAP_ITEMS items aleatórios e retira todos os items.
+ *
+ * @param reps Repetições.
+ */
+static void bench_heap_ops(int reps)
+{
+	int *ids = (int *) emalloc(HEAP_ITEMS * sizeof(int));
+	int *order = (int *) emalloc(HEAP_ITEMS * sizeof(int));
+	double ns_ins[MAX_REPS], ns_dec[MAX_REPS], ns_del[MAX_REPS];
+	double start;
+	Heap *h;
+	int r, i;
+
+	mb_key = (int *) emalloc(HEAP_ITEMS * sizeof(int));
+	for (i = 0; i < HEAP_ITEMS; i++) {
+		ids[i] = i;
+	}
+
+	for (r = 0; r < reps; r++) {
+		h = h_init(HEAP_ITEMS);
+		for (i = 0; i < HEAP_ITEMS; i++) {
+			mb_key[i] = mb_rand() % 1000000;
+			order[i] = mb_rand() % HEAP_ITEMS;
+		}
+
+		start = mono_time();
+		for (i = 0; i < HEAP_ITEMS; i++) {
+			h_insert(h, &ids[i], mb_less_pri, mb_hash);
+		}
+		ns_ins[r] = (mono_time() - start) * 1e9 / HEAP_ITEMS;
+
+		start = mono_time();
+		for (i = 0; i < HEAP_ITEMS; i++) {
+			mb_key[order[i]] /= 2;
+			h_inc_pri(h, &ids[order[i]], mb_less_pri, mb_hash);
+		}
+		ns_dec[r] = (mono_time() - start) * 1e9 / HEAP_ITEMS;
+
+		start = mono_time();
+		while (!h_empty(h)) {
+			h_del_max_pri(h, mb_less_pri, mb_hash);
+		}
+		ns_del[r] = (mono_time() - start) * 1e9 / HEAP_ITEMS;
+
+		h_free(h);
+	}
+
+	report("h_insert", ns_ins, reps, HEAP_ITEMS);
+	report("h_inc_pri", ns_dec, reps, HEAP_ITEMS);
+	report("h_del_max_pri", ns_del, reps, HEAP_ITEMS);
+
+	free(mb_key);
+	free(order);
+	free(ids);
+}
+
+/**
+ * @brief Sequência sintética de operações ao estilo de Dijkstra.
+ * @details Grafo implícito de HEAP_ITEMS vértices com SYNTH_DEGREE vizinhos
+ *	pseudo-aleatórios cada, pesos 1, 4 ou 9 (quadrados das diferenças de
+ *	letras, como no wordmorph). As chaves retiradas são monótonas, tal como
+ *	em shortest_path(). O tempo inclui o cálculo dos vizinhos, que é igual
+ *	para todas as implementações da fila.
+ *
+ * @param reps Repetições.
+ */
+static void bench_heap_dijkstra(int reps)
+{
+	int *ids = (int *) emalloc(HEAP_ITEMS * sizeof(int));
+	char *done = (char *) emalloc(HEAP_ITEMS);
+	double ns[MAX_REPS];
+	double start;
+	long ops = 0;
+	Heap *h;
+	int r, i, v, u, w;
+
+	mb_key = (int *) emalloc(HEAP_ITEMS * sizeof(int));
+	for (i = 0; i < HEAP_ITEMS; i++) {
+		ids[i] = i;
+	}
+
+	for (r = 0; r < reps; r++) {
+		h = h_init(HEAP_ITEMS);
+		for (i = 0; i < HEAP_ITEMS; i++) {
+			mb_key[i] = -1;
+			done[i] = 0;
+		}
+		ops = 0;
+
+		start = mono_time();
+		mb_key[0] = 0;
+		h_insert(h, &ids[0], mb_less_pri, mb_hash);
+		while (!h_empty(h)) {
+			v = *((int *) h_del_max_pri(h, mb_less_pri, mb_hash));
+			done[v] = 1;
+			ops++;
+			for (i = 0; i < SYNTH_DEGREE; i++) {
+				u = (int) ((v * 2654435761u + i * 40503u) % HEAP_ITEMS);
+				w = 1 + (v + i) % 3;
+				w *= w;
+				if (done[u]) {
+					continue;
+				}
+				if (mb_key[u] < 0) {
+					mb_key[u] = mb_key[v] + w;
+					h_insert(h, &ids[u], mb_less_pri, mb_hash);
+					ops++;
+				}
+				else if (mb_key[v] + w < mb_key[u]) {
+					mb_key[u] = mb_key[v] + w;
+					h_inc_pri(h, &ids[u], mb_less_pri, mb_hash);
+					ops++;
+				}
+			}
+		}
+		ns[r] = (mono_time() - start) * 1e9 / ops;
+
+		h_free(h);
+	}
+
+	report("heap dijkstra stream", ns, reps, ops);
+
+	free(mb_key);
+	free(done);
+	free(ids);
+}
+
+/**
+ * @brief Acrescenta uma operação ao traço.
+ */
+static void trace_push(int op, int v, int key)
+{
+	static long max = 0;
+
+	if (trace_len == max) {
+		max = max ? 2 * max : 65536;
+		trace = (TraceOp *) erealloc(trace, max * sizeof(TraceOp));
+	}
+	trace[trace_len].op = op;
+	trace[trace_len].v = v;
+	trace[trace_len].key = key;
+	trace_len++;
+}
+
+/**
+ * @brief Grava as operações da fila das pesquisas de Dijkstra dos problemas
+ *	de um .pal.
+ * @details Só são usados os problemas com o tamanho de palavra do primeiro,
+ *	no grafo das palavras desse tamanho do dicionário, com o maior número
+ *	de permutações desses problemas. Cada pesquisa é como a de
+ *	shortest_path(): da origem até o destino sair da fila. As chaves são
+ *	desempatadas pelo vértice (distância * vértices + vértice), para que
+ *	qualquer fila retire os vértices pela ordem gravada.
+ *
+ * @param words Palavras do dicionário.
+ * @param n Número de palavras.
+ * @param pal Nome do .pal.
+ * @return 0 em caso de sucesso, -1 se não houver problemas a gravar.
+ */
+static int record_trace(Item *words, int n, const char *pal)
+{
+	FILE *f = efopen(pal, "r");
+	char w1[MAX_WORD_SIZE], w2[MAX_WORD_SIZE];
+	char (*pb)[2][MAX_WORD_SIZE] = emalloc(TRACE_PROBLEMS * sizeof(*pb));
+	unsigned short perm, max_perm = 0, max_weight;
+	int *ids, *dist;
+	char *done;
+	size_t len = 0;
+	int num = 0, size = 0, i, k, src, dst, v, u, w;
+	Graph *g;
+	Heap *h;
+	Edge *l;
+
+	while (num < TRACE_PROBLEMS && fscanf(f, "%63s %63s %hu", w1, w2, &perm) == 3) {
+		if (len == 0) {
+			len = strlen(w1);
+		}
+		if (strlen(w1) == len && strlen(w2) == len) {
+			strcpy(pb[num][0], w1);
+			strcpy(pb[num][1], w2);
+			num++;
+			max_perm = perm > max_perm ? perm : max_perm;
+		}
+	}
+	fclose(f);
+
+	for (i = 0; i < n; i++) {
+		size += strlen(words[i]) == len;
+	}
+	if (num == 0 || size == 0 || size > 65535) {
+		free(pb);
+		return -1;
+	}
+
+	g = g_init(size, max_perm);
+	for (i = 0; i < n; i++) {
+		if (strlen(words[i]) == len) {
+			g_insert(g, words[i]);
+		}
+	}
+	g_make_edges(g, w_diff);
+	max_weight = g_get_max_weight(g);
+
+	ids = (int *) emalloc(size * sizeof(int));
+	dist = (int *) emalloc(size * sizeof(int));
+	done = (char *) emalloc(size);
+	mb_key = (int *) emalloc(size * sizeof(int));
+	for (i = 0; i < size; i++) {
+		ids[i] = i;
+	}
+	h = h_init(size);
+
+	for (k = 0; k < num; k++) {
+		src = g_find_vertex(g, pb[k][0], w_cmp);
+		dst = g_find_vertex(g, pb[k][1], w_cmp);
+		if (src == -1 || dst == -1) {
+			continue;
+		}
+
+		trace_push(OP_CLEAR, 0, 0);
+		h_clear(h);
+		for (i = 0; i < size; i++) {
+			dist[i] = -1;
+			done[i] = 0;
+		}
+		dist[src] = 0;
+		mb_key[src] = src;
+		h_insert(h, &ids[src], mb_less_pri, mb_hash);
+		trace_push(OP_INSERT, src, mb_key[src]);
+
+		while (!h_empty(h)) {
+			v = *((int *) h_del_max_pri(h, mb_less_pri, mb_hash));
+			trace_push(OP_POP, v, 0);
+			if (v == dst) {
+				break;
+			}
+			done[v] = 1;
+			for (l = v_get_adj(g_get_vertex(g, v)); l != NULL; l = e_get_next(l)) {
+				w = e_get_weight(l);
+				u = e_get_index(l);
+				if (w > max_weight || done[u]
+						|| (dist[u] >= 0 && dist[v] + w >= dist[u])) {
+					continue;
+				}
+				if ((long) (dist[v] + w) * size + u > 2147483647L) {
+					fprintf(stderr, "Erro: distâncias grandes de mais para o traço.\n");
+					exit(EXIT_FAILURE);
+				}
+				mb_key[u] = (dist[v] + w) * size + u;
+				if (dist[u] < 0) {
+					h_insert(h, &ids[u], mb_less_pri, mb_hash);
+					trace_push(OP_INSERT, u, mb_key[u]);
+				}
+				else {
+					h_inc_pri(h, &ids[u], mb_less_pri, mb_hash);
+					trace_push(OP_DECREASE, u, mb_key[u]);
+				}
+				dist[u] = dist[v] + w;
+			}
+		}
+	}
+
+	printf("traço de %s: %d problemas de %d letras, %ld operações\n\n",
+		pal, num, (int) len, trace_len);
+	trace_size = size;
+
+	h_free(h);
+	g_free(g, mb_keep);
+	free(mb_key);
+	free(done);
+	free(dist);
+	free(ids);
+	free(pb);
+	return 0;
+}
+
+/**
+ * @brief Reproduz o traço gravado em heap.c e nos acervos de dheap.h.
+ * @details O tempo é dado por operação do traço (inserções, reduções e
+ *	remoções). Os vértices retirados são comparados com os gravados. Na
+ *	fila com cópias (LHeap), cada redução insere uma cópia e cada remoção
+ *	descarta as cópias de vértices já retirados, como em --queue=lazy.
+ *
+ * @param reps Repetições.
+ */
+static void bench_trace(int reps)
+{
+	int *ids = (int *) emalloc(trace_size * sizeof(int));
+	double ns_heap[MAX_REPS], ns_dheap[MAX_REPS], ns_lheap[MAX_REPS];
+	double start;
+	long ops = 0, wrong = 0, stale = 0, i;
+	Heap *h;
+	DHeap *d;
+	LHeap *lh;
+	char *popped = (char *) emalloc(trace_size);
+	TraceOp *t;
+	int r, v;
+
+	mb_key = (int *) emalloc(trace_size * sizeof(int));
+	for (v = 0; v < trace_size; v++) {
+		ids[v] = v;
+	}
+	for (i = 0; i < trace_len; i++) {
+		ops += trace[i].op != OP_CLEAR;
+	}
+
+	for (r = 0; r < reps; r++) {
+		h = h_init(trace_size);
+		start = mono_time();
+		for (i = 0, t = trace; i < trace_len; i++, t++) {
+			switch (t->op) {
+			case OP_INSERT:
+				mb_key[t->v] = t->key;
+				h_insert(h, &ids[t->v], mb_less_pri, mb_hash);
+				break;
+			case OP_DECREASE:
+				mb_key[t->v] = t->key;
+				h_inc_pri(h, &ids[t->v], mb_less_pri, mb_hash);
+				break;
+			case OP_POP:
+				wrong += *((int *) h_del_max_pri(h, mb_less_pri, mb_hash)) != t->v;
+				break;
+			default:
+				h_clear(h);
+			}
+		}
+		ns_heap[r] = (mono_time() - start) * 1e9 / ops;
+		h_free(h);
+
+		d = dh_init(trace_size);
+		start = mono_time();
+		for (i = 0, t = trace; i < trace_len; i++, t++) {
+			switch (t->op) {
+			case OP_INSERT:
+				dh_insert(d, t->v, t->key);
+				break;
+			case OP_DECREASE:
+				dh_decrease(d, t->v, t->key);
+				break;
+			case OP_POP:
+				wrong += dh_pop(d) != t->v;
+				break;
+			default:
+				dh_clear(d);
+			}
+		}
+		ns_dheap[r] = (mono_time() - start) * 1e9 / ops;
+		dh_free(d);
+
+		lh = lh_init(trace_size);
+		stale = 0;
+		start = mono_time();
+		for (i = 0, t = trace; i < trace_len; i++, t++) {
+			switch (t->op) {
+			case OP_INSERT:
+			case OP_DECREASE:
+				lh_push(lh, t->v, t->key);
+				break;
+			case OP_POP:
+				while (popped[v = lh_pop(lh)]) {
+					stale++;
+				}
+				popped[v] = 1;
+				wrong += v != t->v;
+				break;
+			default:
+				lh_clear(lh);
+				memset(popped, 0, trace_size);
+			}
+		}
+		ns_lheap[r] = (mono_time() - start) * 1e9 / ops;
+		lh_free(lh);
+	}
+
+	report("trace heap.c", ns_heap, reps, ops);
+	report("trace dheap.h", ns_dheap, reps, ops);
+	report("trace dheap.h lazy", ns_lheap, reps, ops);
+	printf("(lazy: %ld cópias descartadas)\n", stale);
+	if (wrong > 0) {
+		printf("Erro: %ld vértices retirados fora da ordem do traço.\n", wrong);
+	}
+
+	free(popped);
+	free(mb_key);
+	free(ids);
+}
+
+/**
+ * @brief g_make_edges() sobre as primeiras n palavras do dicionário.
+ * @details O tempo é dado por par de palavras comparado, n(n-1)/2 pares.
+ *
+ * @param words Palavras (todas do mesmo tamanho).
+ * @param n Número de palavras a usar.
+ * @param max_perm Número máximo de permutações do grafo.
+ * @param reps Repetições.
+ */
+static void bench_make_edges(Item *words, int n, unsigned short max_perm, int reps)
+{
+	double ns[MAX_REPS];
+	double start;
+	long pairs = (long) n * (n - 1) / 2;
+	char name[32];
+	Graph *g;
+	int r, i;
+
+	for (r = 0; r < reps; r++) {
+		g = g_init(n, max_perm);
+		for (i = 0; i < n; i++) {
+			g_insert(g, words[i]);
+		}
+
+		start = mono_time();
+		g_make_edges(g, w_diff);
+		ns[r] = (mono_time() - start) * 1e9 / pairs;
+
+		g_free(g, mb_keep);
+	}
+
+	sprintf(name, "g_make_edges (max %hu)", max_perm);
+	report(name, ns, reps, pairs);
+}
+
+int main(int argc, char **argv)
+{
+	const char *dic = "../vrfy/portugues08.dic";
+	const char *pal = NULL;
+	int reps = 15;
+	int graph_words = 4000;
+	Item *words;
+	int n, i, same;
+
+	for (i = 1; i < argc; i++) {
+		if (strncmp(argv[i], "--reps=", 7) == 0) {
+			reps = atoi(argv[i] + 7);
+		}
+		else if (strncmp(argv[i], "--graph-words=", 14) == 0) {
+			graph_words = atoi(argv[i] + 14);
+		}
+		else if (strncmp(argv[i], "--trace=", 8) == 0) {
+			pal = argv[i] + 8;
+		}
+		else if (argv[i][0] != '-') {
+			dic = argv[i];
+		}
+		else {
+			fprintf(stderr, "Utilização: %s [--reps=N] [--graph-words=N] "
+				"[--trace=F.pal] [dicionário.dic]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (reps < 1 || reps > MAX_REPS) {
+		reps = reps < 1 ? 1 : MAX_REPS;
+	}
+
+	words = read_words(dic, &n);
+	if (n < 2) {
+		fprintf(stderr, "Erro: o dicionário %s tem menos de 2 palavras.\n", dic);
+		return EXIT_FAILURE;
+	}
+
+	/* O grafo usa as primeiras palavras com o tamanho da primeira. */
+	for (same = 1; same < n && same < graph_words && same < 65535
+			&& strlen(words[same]) == strlen(words[0]); same++)
+		;
+
+	printf("%s: %d palavras, %d repetições\n\n", dic, n, reps);
+	if (pal != NULL && record_trace(words, n, pal) != 0) {
+		fprintf(stderr, "Erro: %s não tem problemas com palavras de %s.\n",
+			pal, dic);
+		return EXIT_FAILURE;
+	}
+	/* Cabeçalho escrito à mão: os acentos estragam o alinhamento de %s. */
+	printf("ns/op                           ops    mediana     mínimo      média     desvio\n");
+
+	bench_diff(words, n, 1, reps);
+	bench_diff(words, n, MAX_WORD_SIZE, reps);
+	bench_heap_ops(reps);
+	bench_heap_dijkstra(reps);
+	if (pal != NULL) {
+		bench_trace(reps);
+	}
+	for (i = 1; i <= 3; i++) {
+		bench_make_edges(words, same, i, reps < 5 ? reps : 5);
+	}
+
+	for (i = 0; i < n; i++) {
+		w_free(words[i]);
+	}
+	free(words);
+	free(trace);
+
+	return EXIT_SUCCESS;
+}
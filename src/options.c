@@ -0,0 +1,219 @@
+/**
+ * @file options.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Opções da linha de comandos.
+ * @details
+ *	As opções são lidas uma única vez em main() e ficam disponíveis,
+ *	apenas para leitura, na variável global options.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "options.h"
+#include "dijkstra.h"
+#include "reorder.h"
+
+/* Valores por omissão: comportamento original do programa. */
+Options options = {0, NULL, 0, 0, 0, 0, 0, NULL, NULL, 0, NULL, 4, 0, 0, 1, 0, 0, NULL, SP_QUEUE_HEAP, 0, -1, RO_NONE, 0};
+
+/**
+ * @brief Devolve o valor de uma opção da forma --nome=valor.
+ *
+ * @param arg Argumento da linha de comandos.
+ * @param name Nome da opção, incluindo "--" e "=".
+ * @return Ponteiro para o valor dentro de arg, ou NULL se arg não for
+ *	a opção name.
+ */
+static char *opt_value(char *arg, const char *name)
+{
+	size_t len = strlen(name);
+
+	if (strncmp(arg, name, len) != 0) {
+		return NULL;
+	}
+	return arg + len;
+}
+
+/**
+ * @brief Lê um inteiro não negativo do valor de uma opção.
+ *
+ * @param value Valor da opção.
+ * @param out Onde guardar o inteiro lido.
+ * @return 0 em caso de sucesso, -1 se o valor for inválido.
+ */
+static int opt_int(const char *value, int *out)
+{
+	char *end;
+	long n = strtol(value, &end, 10);
+
+	if (*value == '\0' || *end != '\0' || n < 0) {
+		return -1;
+	}
+	*out = (int) n;
+	return 0;
+}
+
+/**
+ * @brief Ler as opções da linha de comandos para a variável options.
+ * @details As opções começam por "--" e precedem os argumentos
+ *	posicionais (ficheiros).
+ *
+ * @param argc Número de argumentos.
+ * @param argv Argumentos.
+ * @return Índice em argv do primeiro argumento posicional, ou -1 se alguma
+ *	opção for inválida.
+ */
+int parse_options(int argc, char **argv)
+{
+	int i;
+	char *value;
+
+	for (i = 1; i < argc && strncmp(argv[i], "--", 2) == 0; i++) {
+		if ((value = opt_value(argv[i], "--alt=")) != NULL) {
+			if (opt_int(value, &options.alt_landmarks) != 0) {
+				return -1;
+			}
+		}
+		else if ((value = opt_value(argv[i], "--alt-file=")) != NULL) {
+			options.alt_file = value;
+		}
+		else if (strcmp(argv[i], "--ch") == 0) {
+			options.ch = 1;
+		}
+		else if ((value = opt_value(argv[i], "--query-timeout=")) != NULL) {
+			if (opt_int(value, &options.query_timeout) != 0) {
+				return -1;
+			}
+		}
+		else if ((value = opt_value(argv[i], "--max-settled=")) != NULL) {
+			if (opt_int(value, &options.max_settled) != 0) {
+				return -1;
+			}
+		}
+		else if ((value = opt_value(argv[i], "--batch-timeout=")) != NULL) {
+			if (opt_int(value, &options.batch_timeout) != 0) {
+				return -1;
+			}
+		}
+		else if (strcmp(argv[i], "--stats") == 0) {
+			options.stats = 1;
+		}
+		else if ((value = opt_value(argv[i], "--stats=")) != NULL) {
+			options.stats = 1;
+			options.stats_file = value;
+		}
+		else if ((value = opt_value(argv[i], "--query-csv=")) != NULL) {
+			options.query_csv = value;
+		}
+		else if (strcmp(argv[i], "--by-length") == 0) {
+			options.by_length = 1;
+		}
+		else if ((value = opt_value(argv[i], "--pipeline=")) != NULL) {
+			if (opt_int(value, &options.pipeline) != 0 || options.pipeline < 1) {
+				return -1;
+			}
+		}
+		else if ((value = opt_value(argv[i], "--build-threads=")) != NULL) {
+			if (opt_int(value, &options.build_threads) != 0
+					|| options.build_threads < 1) {
+				return -1;
+			}
+		}
+		else if ((value = opt_value(argv[i], "--tree-cache=")) != NULL) {
+			if (opt_int(value, &options.tree_cache) != 0) {
+				return -1;
+			}
+		}
+		else if (strcmp(argv[i], "--result-cache") == 0) {
+			options.result_cache = 1;
+		}
+		else if ((value = opt_value(argv[i], "--result-cache=")) != NULL) {
+			options.result_cache = 1;
+			options.result_file = value;
+		}
+		else if ((value = opt_value(argv[i], "--queue=")) != NULL) {
+			if ((options.queue = sp_queue_find(value)) < 0) {
+				return -1;
+			}
+		}
+		else if ((value = opt_value(argv[i], "--renumber=")) != NULL) {
+			if ((options.renumber = ro_find(value)) < 0) {
+				return -1;
+			}
+		}
+		else if (strcmp(argv[i], "--packed-adj") == 0) {
+			options.packed_adj = 1;
+		}
+		else if ((value = opt_value(argv[i], "--out-format=")) != NULL) {
+			if (strcmp(value, "text") == 0) {
+				options.path_binary = 0;
+			}
+			else if (strcmp(value, "binary") == 0) {
+				options.path_binary = 1;
+			}
+			else {
+				return -1;
+			}
+		}
+		else if (strcmp(argv[i], "--server") == 0) {
+			options.server = 1;
+		}
+		else if ((value = opt_value(argv[i], "--socket=")) != NULL) {
+			options.socket_path = value;
+		}
+		else if ((value = opt_value(argv[i], "--workers=")) != NULL) {
+			if (opt_int(value, &options.workers) != 0 || options.workers < 1) {
+				return -1;
+			}
+		}
+		else {
+			return -1;
+		}
+	}
+
+	return i;
+}
+
+/**
+ * @brief Imprime a forma de utilização do programa.
+ *
+ * @param prog Nome do programa (argv[0]).
+ */
+void usage(const char *prog)
+{
+	fprintf(stderr, "Utilização: %s [opções] dicionário.dic problemas.pal|.bpal|-\n"
+		"       %s --server [opções] dicionário.dic\n"
+		"       %s --socket=S [--workers=N] [opções] dicionário.dic\n",
+		prog, prog, prog);
+	/* Em C89 as strings literais não devem passar de 509 caracteres. */
+	fprintf(stderr, "Opções:\n"
+		"  --alt=N         pesquisa A* com N marcos (ALT) por grafo\n"
+		"  --alt-file=F    guardar/ler as tabelas de marcos em F\n"
+		"  --ch            usar hierarquias de contração\n"
+		"  --queue=Q       fila das pesquisas: heap, lazy, radix ou bucket\n"
+		"  --renumber=O    renumerar os vértices: none, bfs, rcm ou degree\n"
+		"  --query-timeout=MS  desistir de um problema ao fim de MS ms\n"
+		"  --max-settled=N     desistir de um problema ao fim de N vértices\n"
+		"  --batch-timeout=MS  desistir dos problemas restantes ao fim de MS ms\n");
+	fprintf(stderr, "  --by-length     resolver um tamanho de palavra de cada vez (menos memória)\n"
+		"  --pipeline=K    como --by-length, construindo o grafo seguinte ao mesmo\n"
+		"                  tempo, com até K grafos em memória\n"
+		"  --build-threads=N   construir as arestas com N fios em paralelo\n"
+		"  --tree-cache=MB     guardar árvores de caminhos por origem (até MB MiB)\n"
+		"  --result-cache[=F]  reutilizar resultados de problemas repetidos\n"
+		"                      (guardados em F entre execuções)\n");
+	fprintf(stderr, "  --packed-adj    comprimir as listas de adjacências (menos memória)\n"
+		"  --out-format=F  resultados em text (.path) ou binary (.bpath); por\n"
+		"                  omissão, binary se os problemas forem um .bpal (só\n"
+		"                  sem --server e --socket)\n");
+	fprintf(stderr, "  --stats         relatório de tempos e memória no stderr\n"
+		"  --stats=F       relatório de tempos e memória em JSON no ficheiro F\n"
+		"  --query-csv=F   contadores de cada problema em CSV no ficheiro F\n"
+		"  --server        ler problemas do stdin e escrever caminhos no stdout\n"
+		"  --socket=S      servir problemas na socket Unix S (daemon)\n"
+		"  --workers=N     ligações (--socket) ou fios (--pipeline) em paralelo (4)\n");
+}
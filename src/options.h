@@ -0,0 +1,98 @@
+/**
+ * @file options.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Opções da linha de comandos.
+ * @details
+ *	As opções são lidas uma única vez em main() e ficam disponíveis,
+ *	apenas para leitura, na variável global options.
+ */
+#ifndef _OPTIONS_H
+#define _OPTIONS_H
+
+/**
+ * @brief Opções do programa.
+ * @details alt_landmarks: número de marcos (landmarks) por grafo para a
+ *	pesquisa A* com limites ALT; 0 desliga o modo ALT (Dijkstra simples).
+ *	alt_file: ficheiro onde as tabelas de marcos são guardadas e de onde
+ *	são lidas entre execuções; NULL se não for pretendido.
+ *	ch: se verdadeiro, os problemas são resolvidos com hierarquias de
+ *	contração, construídas por grafo e por peso máximo de arestas.
+ *	query_timeout, max_settled: orçamento de cada problema, em milissegundos
+ *	e em vértices fixados; 0 sem limite.
+ *	batch_timeout: prazo, em milissegundos, para resolver todo o .pal;
+ *	0 sem limite.
+ *	stats: se verdadeiro, escreve no fim um relatório de tempos e memória
+ *	por fase e por grafo; stats_file: ficheiro JSON para o relatório, NULL
+ *	para texto no stderr.
+ *	query_csv: ficheiro CSV com os contadores de cada problema, NULL se não
+ *	for pretendido.
+ *	server: se verdadeiro, só é dado o dicionário; os problemas são lidos
+ *	do stdin e os caminhos escritos no stdout, um a um.
+ *	socket_path: se não for NULL, só é dado o dicionário e os problemas
+ *	chegam por ligações à socket Unix com este caminho (modo daemon);
+ *	workers: número de ligações servidas ao mesmo tempo nesse modo (ou de
+ *	fios que resolvem problemas com pipeline).
+ *	by_length: se verdadeiro, o .pal é lido todo e resolvido um tamanho de
+ *	palavra de cada vez, libertando cada grafo antes de construir o
+ *	seguinte; o .path sai pela ordem do .pal.
+ *	pipeline: se não for 0, como by_length, mas o grafo do tamanho seguinte
+ *	é construído enquanto workers fios resolvem os problemas do atual, com
+ *	no máximo pipeline grafos em memória.
+ *	build_threads: fios de execução que constroem as arestas de cada grafo;
+ *	se for mais do que 1, no modo normal o .pal é lido todo e os grafos de
+ *	que precisa são construídos de uma vez, antes de resolver.
+ *	tree_cache: memória, em MiB, da cache de árvores de caminhos de cada
+ *	fio que resolve (Dijkstra simples); 0 sem cache.
+ *	result_cache: se verdadeiro, o resultado de cada problema resolvido é
+ *	guardado e reutilizado pelos problemas iguais, ou ao contrário;
+ *	result_file: ficheiro de onde os resultados são lidos e onde são
+ *	guardados no fim, NULL para os manter só em memória.
+ *	queue: fila prioritária das pesquisas de Dijkstra e A* (SP_QUEUE_* de
+ *	dijkstra.h).
+ *	pal_binary: se positivo, os problemas estão no formato binário de
+ *	binio.h (.bpal); se negativo, vêm do stdin e são binários se
+ *	começarem pela identificação; decidido por main() pelo nome.
+ *	path_binary: se verdadeiro, os resultados são escritos no formato
+ *	binário de binio.h (.bpath); -1 até main() o decidir: se
+ *	--out-format não for dado, binário só se os problemas vierem de um
+ *	.bpal.
+ *	renumber: ordem dos vértices de cada grafo depois de construir as
+ *	arestas (RO_* de reorder.h); RO_NONE mantém a ordem do dicionário.
+ *	packed_adj: se verdadeiro, as listas de adjacências são comprimidas
+ *	depois de construídas (ver packed.h).
+ */
+typedef struct _Options {
+	int alt_landmarks;
+	char *alt_file;
+	int ch;
+	int query_timeout;
+	int max_settled;
+	int batch_timeout;
+	int stats;
+	char *stats_file;
+	char *query_csv;
+	int server;
+	char *socket_path;
+	int workers;
+	int by_length;
+	int pipeline;
+	int build_threads;
+	int tree_cache;
+	int result_cache;
+	char *result_file;
+	int queue;
+	int pal_binary;
+	int path_binary;
+	int renumber;
+	int packed_adj;
+} Options;
+
+extern Options options;
+
+int parse_options(int argc, char **argv);
+void usage(const char *prog);
+
+#endif
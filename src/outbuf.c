@@ -0,0 +1,131 @@
+/**
+ * @file outbuf.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Buffer de saída.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "outbuf.h"
+#include "utils.h"
+
+/* Capacidade inicial do buffer. */
+#define OB_INITIAL 4096
+
+/**
+ * @brief Buffer.
+ * @details data: bytes por escrever
+ *	len: número de bytes em data
+ *	max: capacidade de data
+ */
+struct _OutBuf {
+	char *data;
+	size_t len;
+	size_t max;
+};
+
+/**
+ * @brief Cria um buffer vazio.
+ *
+ * @return Buffer.
+ */
+OutBuf *ob_init(void)
+{
+	OutBuf *b = (OutBuf *) emalloc(sizeof(OutBuf));
+
+	b->data = (char *) emalloc(OB_INITIAL);
+	b->len = 0;
+	b->max = OB_INITIAL;
+
+	return b;
+}
+
+/**
+ * @brief Liberta o buffer, sem escrever o que ainda tiver.
+ *
+ * @param b Buffer.
+ */
+void ob_free(OutBuf *b)
+{
+	free(b->data);
+	free(b);
+}
+
+/**
+ * @brief Garante espaço para mais n bytes.
+ */
+static void ob_reserve(OutBuf *b, size_t n)
+{
+	if (b->len + n <= b->max) {
+		return;
+	}
+	while (b->len + n > b->max) {
+		b->max *= 2;
+	}
+	b->data = (char *) erealloc(b->data, b->max);
+}
+
+/**
+ * @brief Acrescenta n bytes ao buffer.
+ *
+ * @param b Buffer.
+ * @param s Bytes.
+ * @param n Número de bytes.
+ */
+void ob_bytes(OutBuf *b, const char *s, size_t n)
+{
+	ob_reserve(b, n);
+	memcpy(b->data + b->len, s, n);
+	b->len += n;
+}
+
+/**
+ * @brief Acrescenta um carater ao buffer.
+ *
+ * @param b Buffer.
+ * @param c Carater.
+ */
+void ob_char(OutBuf *b, char c)
+{
+	ob_reserve(b, 1);
+	b->data[b->len++] = c;
+}
+
+/**
+ * @brief Acrescenta um inteiro em decimal ao buffer, como "%d".
+ *
+ * @param b Buffer.
+ * @param n Inteiro.
+ */
+void ob_int(OutBuf *b, int n)
+{
+	char digits[12];
+	int i = sizeof(digits);
+	/* Em unsigned, -n não transborda para INT_MIN. */
+	unsigned int u = n < 0 ? 0u - (unsigned int) n : (unsigned int) n;
+
+	do {
+		digits[--i] = '0' + u % 10;
+		u /= 10;
+	} while (u != 0);
+	if (n < 0) {
+		digits[--i] = '-';
+	}
+	ob_bytes(b, digits + i, sizeof(digits) - i);
+}
+
+/**
+ * @brief Escreve o conteúdo do buffer num ficheiro, com um único fwrite(),
+ *	e esvazia-o.
+ *
+ * @param b Buffer.
+ * @param f Ficheiro.
+ */
+void ob_write(OutBuf *b, FILE *f)
+{
+	fwrite(b->data, 1, b->len, f);
+	b->len = 0;
+}
@@ -0,0 +1,27 @@
+/**
+ * @file outbuf.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Buffer de saída.
+ * @details
+ *	Vetor de bytes que cresce à medida das necessidades e é reaproveitado:
+ *	um bloco do .path é montado com ob_*() e escrito de uma só vez com
+ *	ob_write(), em vez de um fprintf() por palavra.
+ */
+#ifndef _OUTBUF_H
+#define _OUTBUF_H
+
+#include <stdio.h>
+
+typedef struct _OutBuf OutBuf;
+
+OutBuf *ob_init(void);
+void ob_free(OutBuf *b);
+void ob_bytes(OutBuf *b, const char *s, size_t n);
+void ob_char(OutBuf *b, char c);
+void ob_int(OutBuf *b, int n);
+void ob_write(OutBuf *b, FILE *f);
+
+#endif
@@ -0,0 +1,254 @@
+/**
+ * @file packed.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Listas de adjacências comprimidas (--packed-adj).
+ * @details
+ *	O formato dos blocos está descrito em packed.h. Como no StreamVByte,
+ *	os comprimentos estão num controlo à parte das diferenças, pelo que a
+ *	descodificação de cada vizinho só tem um salto (pelos 2 bits do
+ *	controlo), em vez de um por byte como num varint simples; como os
+ *	índices têm 16 bits, as diferenças em zigzag têm no máximo 3 bytes.
+ */
+#include <stdlib.h>
+
+#include "packed.h"
+#include "utils.h"
+
+/**
+ * @brief Listas de adjacências comprimidas de um grafo.
+ * @details n: número de vértices
+ *	start: posição do bloco de cada vértice em data (n + 1 posições)
+ *	data: blocos de todos os vértices, seguidos
+ *	bytes: tamanho de data
+ *	wbits: bits de cada peso (4, 8 ou 16)
+ */
+struct _Packed {
+	int n;
+	unsigned long *start;
+	unsigned char *data;
+	unsigned long bytes;
+	int wbits;
+};
+
+/**
+ * @brief Diferença entre dois índices, em zigzag: 0, -1, 1, -2, ... passam
+ *	a 0, 1, 2, 3, ...
+ */
+static unsigned int zigzag(int from, int to)
+{
+	return to >= from ? (unsigned int) (to - from) << 1
+		: ((unsigned int) (from - to) << 1) - 1;
+}
+
+/**
+ * @brief Número de bytes de uma diferença em zigzag, menos um (o código
+ *	de 2 bits do controlo).
+ */
+static int code(unsigned int z)
+{
+	return z < (1u << 8) ? 0 : z < (1u << 16) ? 1 : 2;
+}
+
+/**
+ * @brief Escreve um inteiro em varint (7 bits por byte, o bit mais alto
+ *	indica que há mais bytes).
+ *
+ * @param p Onde escrever, ou NULL para só contar os bytes.
+ * @param x Valor.
+ * @return Número de bytes.
+ */
+static int put_varint(unsigned char *p, unsigned long x)
+{
+	int n = 0;
+
+	do {
+		if (p != NULL) {
+			p[n] = (unsigned char) ((x & 0x7f) | (x > 0x7f ? 0x80 : 0));
+		}
+		n++;
+		x >>= 7;
+	} while (x > 0);
+
+	return n;
+}
+
+/**
+ * @brief Bytes dos pesos de uma lista com n vizinhos.
+ */
+static unsigned long weight_bytes(int wbits, int n)
+{
+	return wbits == 4 ? (unsigned long) (n + 1) / 2
+		: (unsigned long) n * (wbits / 8);
+}
+
+/**
+ * @brief Comprime um bloco: grau, controlo, pesos e diferenças.
+ *
+ * @param p Onde escrever, ou NULL para só contar os bytes.
+ * @param v Índice do vértice.
+ * @param adj Lista de adjacências de v.
+ * @param wbits Bits de cada peso.
+ * @return Número de bytes do bloco.
+ */
+static unsigned long put_block(unsigned char *p, int v, Edge *adj, int wbits)
+{
+	unsigned char *ctrl = NULL, *wts = NULL, *data = NULL;
+	unsigned long bytes;
+	unsigned short w;
+	unsigned int z;
+	int n = 0, k, c, prev = v;
+	Edge *l;
+
+	for (l = adj; l != NULL; l = e_get_next(l)) {
+		n++;
+	}
+	bytes = put_varint(p, n) + (n + 3) / 4 + weight_bytes(wbits, n);
+
+	if (p != NULL) {
+		ctrl = p + put_varint(NULL, n);
+		wts = ctrl + (n + 3) / 4;
+		data = wts + weight_bytes(wbits, n);
+		for (k = 0; k < (n + 3) / 4; k++) {
+			ctrl[k] = 0;
+		}
+		for (k = 0; k < (int) weight_bytes(wbits, n); k++) {
+			wts[k] = 0;
+		}
+	}
+
+	for (l = adj, k = 0; l != NULL; l = e_get_next(l), k++) {
+		z = zigzag(prev, e_get_index(l));
+		prev = e_get_index(l);
+		c = code(z);
+		bytes += c + 1;
+		if (p == NULL) {
+			continue;
+		}
+
+		ctrl[k >> 2] |= (unsigned char) (c << ((k & 3) << 1));
+		for (; c >= 0; c--) {
+			*data++ = (unsigned char) (z & 0xff);
+			z >>= 8;
+		}
+		w = e_get_weight(l);
+		switch (wbits) {
+		case 4:
+			wts[k >> 1] |= (unsigned char) (w << ((k & 1) << 2));
+			break;
+		case 8:
+			wts[k] = (unsigned char) w;
+			break;
+		default:
+			wts[2 * k] = (unsigned char) (w & 0xff);
+			wts[2 * k + 1] = (unsigned char) (w >> 8);
+		}
+	}
+
+	return bytes;
+}
+
+/**
+ * @brief Comprime as listas de adjacências de um grafo.
+ * @details As listas ligadas não são alteradas (ver g_pack()).
+ *
+ * @param g Ponteiro para grafo.
+ * @return Listas comprimidas.
+ */
+Packed *pk_build(Graph *g)
+{
+	Packed *pk = (Packed *) emalloc(sizeof(Packed));
+	int n = g_get_free(g);
+	unsigned short max = 0;
+	int v;
+	Edge *l;
+
+	for (v = 0; v < n; v++) {
+		for (l = v_get_adj(g_get_vertex(g, v)); l != NULL; l = e_get_next(l)) {
+			if (e_get_weight(l) > max) {
+				max = e_get_weight(l);
+			}
+		}
+	}
+	pk->wbits = max < 16 ? 4 : max < 256 ? 8 : 16;
+
+	pk->n = n;
+	pk->start = (unsigned long *) emalloc((n + 1) * sizeof(unsigned long));
+	pk->bytes = 0;
+	for (v = 0; v < n; v++) {
+		pk->start[v] = pk->bytes;
+		pk->bytes += put_block(NULL, v, v_get_adj(g_get_vertex(g, v)), pk->wbits);
+	}
+	pk->start[n] = pk->bytes;
+
+	pk->data = (unsigned char *) emalloc(pk->bytes + 1);
+	for (v = 0; v < n; v++) {
+		put_block(pk->data + pk->start[v], v, v_get_adj(g_get_vertex(g, v)), pk->wbits);
+	}
+
+	return pk;
+}
+
+/**
+ * @brief Liberta listas comprimidas.
+ *
+ * @param pk Listas comprimidas, ou NULL.
+ */
+void pk_free(Packed *pk)
+{
+	if (pk == NULL) {
+		return;
+	}
+	free(pk->start);
+	free(pk->data);
+	free(pk);
+}
+
+/**
+ * @brief Memória ocupada por listas comprimidas.
+ *
+ * @param pk Listas comprimidas.
+ * @return Número de bytes.
+ */
+size_t pk_get_bytes(Packed *pk)
+{
+	return sizeof(Packed) + (pk->n + 1) * sizeof(unsigned long) + pk->bytes + 1;
+}
+
+/**
+ * @brief Começa a percorrer a lista de adjacências de um vértice.
+ *
+ * @param g Ponteiro para grafo.
+ * @param v Índice do vértice.
+ * @param it Posição a iniciar (ver pk_next()).
+ */
+void pk_begin(Graph *g, int v, PkIter *it)
+{
+	Packed *pk = g_get_packed(g);
+	const unsigned char *p;
+	unsigned long n = 0;
+	int shift = 0;
+
+	if (pk == NULL) {
+		it->l = v_get_adj(g_get_vertex(g, v));
+		it->n = -1;
+		return;
+	}
+
+	p = pk->data + pk->start[v];
+	do {
+		n |= (unsigned long) (*p & 0x7f) << shift;
+		shift += 7;
+	} while (*p++ & 0x80);
+
+	it->l = NULL;
+	it->n = (int) n;
+	it->k = 0;
+	it->index = v;
+	it->wbits = pk->wbits;
+	it->ctrl = p;
+	it->wts = p + (n + 3) / 4;
+	it->data = it->wts + weight_bytes(pk->wbits, (int) n);
+}
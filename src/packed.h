@@ -0,0 +1,112 @@
+/**
+ * @file packed.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Listas de adjacências comprimidas (--packed-adj).
+ * @details
+ *	Cada lista é guardada num bloco de bytes, pela mesma ordem da lista
+ *	ligada: o grau, em varint; um byte de controlo por cada 4 vizinhos,
+ *	com 2 bits por vizinho (o número de bytes da sua diferença, de 1 a
+ *	3); os pesos, com 4, 8 ou 16 bits cada, consoante o maior peso do
+ *	grafo; e as diferenças. Cada diferença é a do índice do vizinho para
+ *	o anterior (para o próprio vértice, no primeiro), com sinal em
+ *	zigzag. Sem renumeração as listas estão por índice decrescente e as
+ *	diferenças são todas positivas; com --renumber os vizinhos têm
+ *	índices próximos.
+ *
+ *	PkIter percorre uma lista de adjacências de um grafo, comprimida ou
+ *	não (ver g_pack()): pk_begin() e depois pk_next() até devolver falso.
+ */
+#ifndef _PACKED_H
+#define _PACKED_H
+
+#include "bool.h"
+#include "inline.h"
+#include "graph.h"
+
+/**
+ * @brief Posição numa lista de adjacências.
+ * @details l: aresta seguinte, se a lista não estiver comprimida
+ *	n: grau do vértice, -1 se a lista não estiver comprimida
+ *	k: posição do vizinho seguinte
+ *	index: índice do último vizinho (ou o próprio vértice, no início)
+ *	wbits: bits de cada peso
+ *	ctrl, wts, data: controlo, pesos e diferenças do bloco
+ */
+typedef struct _PkIter {
+	Edge *l;
+	int n;
+	int k;
+	int index;
+	int wbits;
+	const unsigned char *ctrl;
+	const unsigned char *wts;
+	const unsigned char *data;
+} PkIter;
+
+Packed *pk_build(Graph *g);
+void pk_free(Packed *pk);
+size_t pk_get_bytes(Packed *pk);
+void pk_begin(Graph *g, int v, PkIter *it);
+
+/**
+ * @brief Vizinho seguinte de uma lista começada por pk_begin().
+ *
+ * @param it Posição na lista.
+ * @param index Onde guardar o índice do vizinho.
+ * @param weight Onde guardar o peso da aresta.
+ * @return Verdadeiro se havia mais um vizinho, falso no fim da lista.
+ */
+STATIC_INLINE bool pk_next(PkIter *it, unsigned short *index, unsigned short *weight)
+{
+	const unsigned char *d = it->data;
+	int k = it->k;
+	unsigned int z;
+
+	if (it->n < 0) {
+		if (it->l == NULL) {
+			return false;
+		}
+		*index = e_get_index(it->l);
+		*weight = e_get_weight(it->l);
+		it->l = e_get_next(it->l);
+		return true;
+	}
+	if (k == it->n) {
+		return false;
+	}
+
+	switch ((it->ctrl[k >> 2] >> ((k & 3) << 1)) & 3) {
+	case 0:
+		z = d[0];
+		it->data = d + 1;
+		break;
+	case 1:
+		z = d[0] | (unsigned int) d[1] << 8;
+		it->data = d + 2;
+		break;
+	default:
+		z = d[0] | (unsigned int) d[1] << 8 | (unsigned int) d[2] << 16;
+		it->data = d + 3;
+	}
+	it->index += (z & 1) ? -(int) (z >> 1) - 1 : (int) (z >> 1);
+	*index = (unsigned short) it->index;
+
+	switch (it->wbits) {
+	case 4:
+		*weight = (it->wts[k >> 1] >> ((k & 1) << 2)) & 15;
+		break;
+	case 8:
+		*weight = it->wts[k];
+		break;
+	default:
+		*weight = it->wts[2 * k] | (unsigned short) (it->wts[2 * k + 1] << 8);
+	}
+	it->k = k + 1;
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,304 @@
+/**
+ * @file pipeline.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Modo --pipeline: construir o grafo do tamanho de palavra seguinte
+ *	enquanto se resolvem os problemas do atual.
+ * @details
+ *	Os problemas vêm ordenados por tamanho de palavra (ver
+ *	solve_by_length()), e cada tamanho forma um grupo. Um fio construtor
+ *	percorre os grupos por ordem e constrói, para cada um, o grafo, as
+ *	arestas e o pré-processamento pedido (ver so_prepare());
+ *	options.workers fios resolvem os problemas por ordem, esperando que o
+ *	grupo de cada um esteja pronto. Assim g_make_edges() do grupo seguinte
+ *	corre ao mesmo tempo que as pesquisas do atual.
+ *
+ *	O construtor é também quem liberta os grafos, logo que todos os
+ *	problemas do grupo estão resolvidos, e nunca há mais do que
+ *	options.pipeline grafos construídos e por libertar. Com 1, não há
+ *	sobreposição; com 2, o grafo atual e o seguinte.
+ *
+ *	Cada fio que resolve escreve as respostas no seu ficheiro temporário;
+ *	write_path() junta-as no fim pela ordem do .pal.
+ */
+/* Fios de execução são POSIX, não fazem parte de C89. */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "pipeline.h"
+#include "file.h"
+#include "lock.h"
+#include "options.h"
+#include "utils.h"
+
+/**
+ * @brief Problemas de um tamanho de palavra.
+ * @details size: tamanho de palavra
+ *	first, end: problemas [first, end) da tabela ordenada
+ *	done: problemas já resolvidos
+ *	ready: verdadeiro depois de o construtor tratar do grupo
+ *	built: verdadeiro se o construtor construiu o grafo
+ *	freed: verdadeiro depois de o construtor libertar o grafo
+ */
+typedef struct _Group {
+	int size;
+	long first, end;
+	long done;
+	bool ready, built, freed;
+} Group;
+
+/**
+ * @brief Fio de execução que resolve problemas.
+ * @details thread: identificador do fio
+ *	out: ficheiro temporário onde escreve as respostas
+ */
+typedef struct _Worker {
+	pthread_t thread;
+	FILE *out;
+} Worker;
+
+/* Estado da pipeline, partilhado pelos fios. Só há uma por processo.
+ * pl_mutex protege next, resident e os campos done, ready, built e freed
+ * dos grupos; pl_cond assinala as mudanças. */
+static pthread_mutex_t pl_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pl_cond = PTHREAD_COND_INITIALIZER;
+static Problem *pl_pb = NULL;
+static long pl_n = 0;
+static long next = 0; /* Próximo problema a resolver. */
+static Group *groups = NULL;
+static int num_groups = 0;
+static int *group_of = NULL; /* Grupo de cada problema. */
+static int resident = 0; /* Grafos construídos e ainda não libertados. */
+static Graph **pl_graphs = NULL;
+static double pl_batch_end = 0;
+
+/**
+ * @brief Constrói o que os problemas de um grupo precisam, para cada
+ *	número de permutações do grupo.
+ * @details Os problemas de cada grupo estão por ordem decrescente de
+ *	permutações, pelo que as arestas só são construídas uma vez. Depois do
+ *	prazo do lote não se constrói nada: os problemas seriam todos marcados.
+ *
+ * @param so Estado do construtor.
+ * @param gr Grupo.
+ * @return Verdadeiro se alguma coisa foi construída.
+ */
+static bool pl_build(Solver *so, Group *gr)
+{
+	unsigned short prev = 0;
+	bool built = false;
+	long i;
+
+	if (pl_batch_end > 0 && mono_time() > pl_batch_end) {
+		return false;
+	}
+
+	for (i = gr->first; i < gr->end; i++) {
+		if (pl_pb[i].max_perm != prev && pb_needs_graph(&pl_pb[i])) {
+			so_prepare(so, pl_graphs, gr->size, pl_pb[i].max_perm);
+			prev = pl_pb[i].max_perm;
+			built = true;
+		}
+	}
+
+	return built;
+}
+
+/**
+ * @brief Procura um grupo com todos os problemas resolvidos e o grafo por
+ *	libertar. Chamada com pl_mutex.
+ *
+ * @return Índice do grupo, ou -1 se não houver.
+ */
+static int pl_finished(void)
+{
+	int k;
+
+	for (k = 0; k < num_groups; k++) {
+		if (groups[k].ready && !groups[k].freed
+				&& groups[k].done == groups[k].end - groups[k].first) {
+			return k;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * @brief Fio construtor: constrói os grupos por ordem, sem passar de
+ *	options.pipeline grafos em memória, e liberta os que terminaram.
+ *
+ * @param arg Não usado.
+ * @return NULL.
+ */
+static void *pl_builder(void *arg)
+{
+	Solver *so = so_init(lk_lock, lk_unlock);
+	int build = 0; /* Próximo grupo a construir. */
+	int freed = 0; /* Grupos libertados. */
+	int k;
+	bool built;
+
+	(void) arg;
+	while (freed < num_groups) {
+		/* Libertar tem prioridade sobre construir, para que a memória
+		 * baixe o mais cedo possível. */
+		pthread_mutex_lock(&pl_mutex);
+		while ((k = pl_finished()) < 0
+				&& (build == num_groups || resident >= options.pipeline)) {
+			pthread_cond_wait(&pl_cond, &pl_mutex);
+		}
+		pthread_mutex_unlock(&pl_mutex);
+
+		if (k >= 0) {
+			so_release(so, pl_graphs, groups[k].size);
+			pthread_mutex_lock(&pl_mutex);
+			groups[k].freed = true;
+			if (groups[k].built) resident--;
+			pthread_mutex_unlock(&pl_mutex);
+			freed++;
+		}
+		else {
+			built = pl_build(so, &groups[build]);
+			pthread_mutex_lock(&pl_mutex);
+			groups[build].built = built;
+			groups[build].ready = true;
+			if (built) resident++;
+			pthread_cond_broadcast(&pl_cond);
+			pthread_mutex_unlock(&pl_mutex);
+			build++;
+		}
+	}
+
+	so_free(so);
+	return NULL;
+}
+
+/**
+ * @brief Fio que resolve problemas, pela ordem da tabela, até não haver mais.
+ *
+ * @param arg Worker (Worker *).
+ * @return NULL.
+ */
+static void *pl_worker(void *arg)
+{
+	Worker *w = (Worker *) arg;
+	Solver *so = so_init(lk_lock, lk_unlock);
+	Problem *p;
+	Group *gr;
+	long i;
+
+	for (;;) {
+		pthread_mutex_lock(&pl_mutex);
+		if (next == pl_n) {
+			pthread_mutex_unlock(&pl_mutex);
+			break;
+		}
+		i = next++;
+		gr = &groups[group_of[i]];
+		while (!gr->ready) {
+			pthread_cond_wait(&pl_cond, &pl_mutex);
+		}
+		pthread_mutex_unlock(&pl_mutex);
+
+		p = &pl_pb[i];
+		p->out = w->out;
+		p->offset = ftell(w->out);
+		solve_problem(w->out, pl_graphs, (char *) p->word1, (char *) p->word2,
+				p->max_perm, pl_batch_end, so);
+		p->length = ftell(w->out) - p->offset;
+
+		pthread_mutex_lock(&pl_mutex);
+		if (++gr->done == gr->end - gr->first) {
+			pthread_cond_broadcast(&pl_cond);
+		}
+		pthread_mutex_unlock(&pl_mutex);
+	}
+
+	so_free(so);
+	return NULL;
+}
+
+/**
+ * @brief Resolve os problemas com um fio construtor e options.workers fios
+ *	de resolução, e escreve as respostas no .path pela ordem do .pal.
+ *
+ * @param pb Tabela de problemas, de read_pal(), ordenada por tamanho.
+ * @param n Número de problemas.
+ * @param fpath Ficheiro .path de saída.
+ * @param graphs Tabela de grafos.
+ * @param batch_end Prazo do lote (de mono_time()), 0 se não houver.
+ */
+void pl_solve(Problem *pb, long n, FILE *fpath, Graph **graphs, double batch_end)
+{
+	pthread_t builder;
+	Worker *w;
+	int i;
+	long j;
+
+	pl_pb = pb;
+	pl_n = n;
+	pl_graphs = graphs;
+	pl_batch_end = batch_end;
+	next = 0;
+	resident = 0;
+
+	/* Um grupo por tamanho de palavra (os problemas estão ordenados). */
+	groups = (Group *) emalloc((n > 0 ? n : 1) * sizeof(Group));
+	group_of = (int *) emalloc((n > 0 ? n : 1) * sizeof(int));
+	num_groups = 0;
+	for (j = 0; j < n; j++) {
+		if (j == 0 || pb[j].size != pb[j-1].size) {
+			groups[num_groups].size = pb[j].size;
+			groups[num_groups].first = j;
+			groups[num_groups].done = 0;
+			groups[num_groups].ready = false;
+			groups[num_groups].built = false;
+			groups[num_groups].freed = false;
+			num_groups++;
+		}
+		groups[num_groups-1].end = j + 1;
+		group_of[j] = num_groups - 1;
+	}
+
+	lk_init();
+	w = (Worker *) emalloc(options.workers * sizeof(Worker));
+	for (i = 0; i < options.workers; i++) {
+		if ((w[i].out = tmpfile()) == NULL) {
+			fprintf(stderr, "Erro: impossível criar ficheiro temporário.\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (pthread_create(&builder, NULL, pl_builder, NULL) != 0) {
+		fprintf(stderr, "Erro: impossível criar fio construtor.\n");
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < options.workers; i++) {
+		if (pthread_create(&w[i].thread, NULL, pl_worker, &w[i]) != 0) {
+			fprintf(stderr, "Erro: impossível criar worker.\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	for (i = 0; i < options.workers; i++) {
+		pthread_join(w[i].thread, NULL);
+	}
+	pthread_join(builder, NULL);
+	lk_destroy();
+
+	write_path(fpath, pb, n);
+
+	for (i = 0; i < options.workers; i++) {
+		fclose(w[i].out);
+	}
+	free(w);
+	free(groups);
+	free(group_of);
+	groups = NULL;
+	group_of = NULL;
+}
@@ -0,0 +1,20 @@
+/**
+ * @file pipeline.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Modo --pipeline: construir o grafo do tamanho de palavra seguinte
+ *	enquanto se resolvem os problemas do atual.
+ */
+#ifndef _PIPELINE_H
+#define _PIPELINE_H
+
+#include <stdio.h>
+
+#include "graph.h"
+#include "file.h"
+
+void pl_solve(Problem *pb, long n, FILE *fpath, Graph **graphs, double batch_end);
+
+#endif
@@ -0,0 +1,203 @@
+/**
+ * @file radix.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Acervo radix de vértices com chaves inteiras monótonas.
+ * @details
+ *	O balde 0 guarda as chaves iguais à última retirada (last) e o balde
+ *	b > 0 as chaves cujo bit mais alto diferente de last é o bit b - 1.
+ *	Como as chaves nunca descem abaixo de last, a menor chave está no
+ *	primeiro balde não vazio. Quando o balde 0 se esgota, o primeiro balde
+ *	não vazio é redistribuído em relação à sua menor chave, que passa a
+ *	ser last: cada elemento desce para um balde mais baixo, pelo que é
+ *	movido no máximo uma vez por bit, sem nunca comparar chaves duas a
+ *	duas.
+ */
+#include <stdlib.h>
+
+#include "radix.h"
+#include "utils.h"
+
+/* Número de baldes: um por bit de uma chave int, mais o balde 0. */
+#define RH_BUCKETS 33
+
+/**
+ * @brief Elemento do acervo.
+ */
+typedef struct _RhNode {
+	int key;
+	int vertex;
+} RhNode;
+
+/**
+ * @brief Balde: vetor de elementos, sem ordem.
+ */
+typedef struct _RhBucket {
+	RhNode *nodes;
+	int count;
+	int max;
+} RhBucket;
+
+/**
+ * @brief Acervo.
+ * @details bucket: baldes, como descrito acima
+ *	last: última chave retirada (0 depois de rh_clear())
+ *	count: número de elementos em todos os baldes
+ */
+struct _RadixHeap {
+	RhBucket bucket[RH_BUCKETS];
+	unsigned int last;
+	int count;
+};
+
+/**
+ * @brief Número do balde de uma chave: o número de bits de key ^ last.
+ */
+static int rh_bucket(unsigned int key, unsigned int last)
+{
+	unsigned int x = key ^ last;
+#if defined(__GNUC__)
+	return x == 0 ? 0 : 32 - __builtin_clz(x);
+#else
+	int b = 0;
+
+	while (x != 0) {
+		x >>= 1;
+		b++;
+	}
+	return b;
+#endif
+}
+
+/**
+ * @brief Acrescenta um elemento a um balde, que cresce se estiver cheio.
+ */
+static void rh_add(RhBucket *b, int v, int key)
+{
+	if (b->count == b->max) {
+		b->max = b->max ? 2 * b->max : 64;
+		b->nodes = (RhNode *) erealloc(b->nodes, b->max * sizeof(RhNode));
+	}
+	b->nodes[b->count].key = key;
+	b->nodes[b->count].vertex = v;
+	b->count++;
+}
+
+/**
+ * @brief Cria um acervo vazio.
+ * @details Os baldes crescem à medida das necessidades e mantêm a memória
+ *	entre pesquisas.
+ *
+ * @return Acervo.
+ */
+RadixHeap *rh_init(void)
+{
+	RadixHeap *h = (RadixHeap *) emalloc(sizeof(RadixHeap));
+	int i;
+
+	for (i = 0; i < RH_BUCKETS; i++) {
+		h->bucket[i].nodes = NULL;
+		h->bucket[i].count = 0;
+		h->bucket[i].max = 0;
+	}
+	h->last = 0;
+	h->count = 0;
+
+	return h;
+}
+
+/**
+ * @brief Liberta o acervo.
+ *
+ * @param h Acervo.
+ */
+void rh_free(RadixHeap *h)
+{
+	int i;
+
+	for (i = 0; i < RH_BUCKETS; i++) {
+		free(h->bucket[i].nodes);
+	}
+	free(h);
+}
+
+/**
+ * @brief Esvazia o acervo, sem o libertar, e volta a aceitar qualquer chave.
+ *
+ * @param h Acervo.
+ */
+void rh_clear(RadixHeap *h)
+{
+	int i;
+
+	for (i = 0; i < RH_BUCKETS; i++) {
+		h->bucket[i].count = 0;
+	}
+	h->last = 0;
+	h->count = 0;
+}
+
+/**
+ * @brief Verifica se o acervo está vazio.
+ *
+ * @param h Acervo.
+ * @return Verdadeiro se estiver vazio.
+ */
+bool rh_empty(RadixHeap *h)
+{
+	return h->count == 0;
+}
+
+/**
+ * @brief Insere um vértice, que pode já estar no acervo.
+ *
+ * @param h Acervo.
+ * @param v Vértice.
+ * @param key Chave, não negativa e não menor que a última retirada.
+ */
+void rh_push(RadixHeap *h, int v, int key)
+{
+	rh_add(&h->bucket[rh_bucket(key, h->last)], v, key);
+	h->count++;
+}
+
+/**
+ * @brief Retira um vértice de menor chave; o acervo não pode estar vazio.
+ * @details Entre chaves iguais, sai primeiro a última inserida.
+ *
+ * @param h Acervo.
+ * @return Vértice.
+ */
+int rh_pop(RadixHeap *h)
+{
+	RhBucket *b = &h->bucket[0];
+	RhNode *n;
+	unsigned int min;
+	int i, k;
+
+	if (b->count == 0) {
+		for (i = 1; h->bucket[i].count == 0; i++)
+			;
+		b = &h->bucket[i];
+
+		min = (unsigned int) b->nodes[0].key;
+		for (k = 1; k < b->count; k++) {
+			if ((unsigned int) b->nodes[k].key < min) {
+				min = b->nodes[k].key;
+			}
+		}
+
+		/* Todos descem para baldes abaixo de i. */
+		h->last = min;
+		for (k = 0, n = b->nodes; k < b->count; k++, n++) {
+			rh_add(&h->bucket[rh_bucket(n->key, min)], n->vertex, n->key);
+		}
+		b->count = 0;
+		b = &h->bucket[0];
+	}
+
+	h->count--;
+	return b->nodes[--b->count].vertex;
+}
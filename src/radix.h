@@ -0,0 +1,27 @@
+/**
+ * @file radix.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Acervo radix de vértices com chaves inteiras monótonas.
+ * @details
+ *	Fila prioritária em que nenhuma chave inserida pode ser menor que a
+ *	última chave retirada, como em Dijkstra (e em A* com limites
+ *	consistentes). Aceita cópias do mesmo vértice, como LHeap.
+ */
+#ifndef _RADIX_H
+#define _RADIX_H
+
+#include "bool.h"
+
+typedef struct _RadixHeap RadixHeap;
+
+RadixHeap *rh_init(void);
+void rh_free(RadixHeap *h);
+void rh_clear(RadixHeap *h);
+bool rh_empty(RadixHeap *h);
+void rh_push(RadixHeap *h, int v, int key);
+int rh_pop(RadixHeap *h);
+
+#endif
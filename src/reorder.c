@@ -0,0 +1,207 @@
+/**
+ * @file reorder.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Ordens de vértices para renumerar os grafos (--renumber).
+ * @details
+ *	BFS: cada componente por pesquisa em largura, a partir do seu vértice
+ *	de menor índice original, com os vizinhos pela ordem das listas.
+ *
+ *	RCM (Cuthill-McKee invertida): pesquisa em largura a partir de um
+ *	vértice de grau mínimo de cada componente, visitando os vizinhos por
+ *	grau crescente; a ordem final é a inversa. Reduz a largura de banda
+ *	da matriz de adjacências.
+ *
+ *	Grau: vértices por grau decrescente, para que os mais visitados pelas
+ *	pesquisas fiquem juntos no início das tabelas.
+ *
+ *	Os empates são decididos pelo índice original (ver g_get_orig()), pelo
+ *	que a ordem não depende de uma renumeração anterior.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "reorder.h"
+#include "utils.h"
+
+static const char *order_names[RO_NUM_ORDERS] = {"none", "bfs", "rcm", "degree"};
+
+/**
+ * @brief Comparador para qsort(): chaves crescentes.
+ */
+static int key_cmp(const void *a, const void *b)
+{
+	unsigned long x = *(const unsigned long *) a, y = *(const unsigned long *) b;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Grau de um vértice.
+ */
+static unsigned short degree(Graph *g, int v)
+{
+	unsigned short d = 0;
+	Edge *l;
+
+	for (l = v_get_adj(g_get_vertex(g, v)); l != NULL; l = e_get_next(l)) {
+		d++;
+	}
+
+	return d;
+}
+
+/**
+ * @brief Chave de ordenação de um vértice: primeiro o valor pedido,
+ *	depois o índice original.
+ */
+static unsigned long order_key(Graph *g, int v, unsigned short value)
+{
+	return ((unsigned long) value << 16) | g_get_orig(g, v);
+}
+
+/**
+ * @brief Ordena vértices por chave de order_key() e substitui cada chave
+ *	pelo índice atual do vértice.
+ */
+static void sort_keys(Graph *g, unsigned long *keys, int n, unsigned short *out)
+{
+	int i;
+
+	qsort(keys, n, sizeof(unsigned long), key_cmp);
+	for (i = 0; i < n; i++) {
+		out[i] = g_get_index(g, (unsigned short) (keys[i] & 0xffff));
+	}
+}
+
+/**
+ * @brief Pesquisas em largura que cobrem o grafo, pela ordem de partida
+ *	dada.
+ *
+ * @param g Ponteiro para grafo.
+ * @param starts Vértices de partida candidatos, por ordem.
+ * @param by_degree Visitar os vizinhos de cada vértice por grau crescente
+ *	em vez de pela ordem da lista.
+ * @param order Onde guardar a ordem de visita (g_get_size() vértices).
+ */
+static void bfs(Graph *g, const unsigned short *starts, bool by_degree,
+		unsigned short *order)
+{
+	int n = g_get_size(g);
+	char *seen = (char *) ecalloc(n, 1);
+	unsigned long *keys = (unsigned long *) emalloc((n + 1) * sizeof(unsigned long));
+	int head = 0, tail = 0, first, i, k, v, w;
+	Edge *l;
+
+	for (i = 0; i < n; i++) {
+		if (seen[starts[i]]) {
+			continue;
+		}
+		seen[starts[i]] = 1;
+		order[tail++] = starts[i];
+		while (head < tail) {
+			v = order[head++];
+			first = tail;
+			k = 0;
+			for (l = v_get_adj(g_get_vertex(g, v)); l != NULL; l = e_get_next(l)) {
+				w = e_get_index(l);
+				if (!seen[w]) {
+					seen[w] = 1;
+					order[tail++] = w;
+					if (by_degree) {
+						keys[k++] = order_key(g, w, degree(g, w));
+					}
+				}
+			}
+			if (by_degree) {
+				sort_keys(g, keys, k, order + first);
+			}
+		}
+	}
+
+	free(seen);
+	free(keys);
+}
+
+/**
+ * @brief Calcula uma nova ordem para os vértices de um grafo, para
+ *	g_permute(), com as arestas já construídas.
+ *
+ * @param g Ponteiro para grafo.
+ * @param method Ordem (RO_*, diferente de RO_NONE).
+ * @return Tabela com o índice atual do vértice que fica em cada posição,
+ *	a libertar com free().
+ */
+unsigned short *ro_order(Graph *g, int method)
+{
+	int n = g_get_size(g);
+	unsigned short *order = (unsigned short *) emalloc((n + 1) * sizeof(unsigned short));
+	unsigned short *starts = (unsigned short *) emalloc((n + 1) * sizeof(unsigned short));
+	unsigned long *keys = (unsigned long *) emalloc((n + 1) * sizeof(unsigned long));
+	unsigned short tmp;
+	int i, v;
+
+	for (i = 0; i < n; i++) {
+		starts[i] = g_get_index(g, i);
+	}
+
+	switch (method) {
+	case RO_BFS:
+		bfs(g, starts, false, order);
+		break;
+	case RO_RCM:
+		for (v = 0; v < n; v++) {
+			keys[v] = order_key(g, v, degree(g, v));
+		}
+		sort_keys(g, keys, n, starts);
+		bfs(g, starts, true, order);
+		for (i = 0; i < n / 2; i++) {
+			tmp = order[i];
+			order[i] = order[n - 1 - i];
+			order[n - 1 - i] = tmp;
+		}
+		break;
+	default:
+		for (v = 0; v < n; v++) {
+			keys[v] = order_key(g, v, (unsigned short) (0xffff - degree(g, v)));
+		}
+		sort_keys(g, keys, n, order);
+		break;
+	}
+
+	free(starts);
+	free(keys);
+
+	return order;
+}
+
+/**
+ * @brief Nome de uma ordem (ver --renumber).
+ *
+ * @param method Ordem (RO_*).
+ * @return Nome.
+ */
+const char *ro_name(int method)
+{
+	return order_names[method];
+}
+
+/**
+ * @brief Procura uma ordem pelo nome.
+ *
+ * @param name Nome (ver ro_name()).
+ * @return Ordem (RO_*), ou -1 se não houver nenhuma com esse nome.
+ */
+int ro_find(const char *name)
+{
+	int i;
+
+	for (i = 0; i < RO_NUM_ORDERS; i++) {
+		if (strcmp(name, order_names[i]) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
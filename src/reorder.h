@@ -0,0 +1,28 @@
+/**
+ * @file reorder.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Ordens de vértices para renumerar os grafos (--renumber).
+ * @details
+ *	Na ordem do dicionário, os vizinhos de uma palavra estão espalhados
+ *	pelas tabelas indexadas por vértice das pesquisas. Estas ordens põem
+ *	vizinhos com índices próximos; a renumeração é feita por g_permute().
+ */
+#ifndef _REORDER_H
+#define _REORDER_H
+
+#include "graph.h"
+
+#define RO_NONE 0 /* Ordem do dicionário. */
+#define RO_BFS 1 /* Pesquisa em largura. */
+#define RO_RCM 2 /* Cuthill-McKee invertida. */
+#define RO_DEGREE 3 /* Grau decrescente. */
+#define RO_NUM_ORDERS 4
+
+unsigned short *ro_order(Graph *g, int method);
+const char *ro_name(int method);
+int ro_find(const char *name);
+
+#endif
@@ -0,0 +1,387 @@
+/**
+ * @file result.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Cache de resultados de problemas (--result-cache).
+ * @details
+ *	Tabela de dispersão com encadeamento, partilhada por todos os fios de
+ *	execução, que a usam dentro do trinco das estatísticas (lock(0, true),
+ *	ver Solver em file.h). Os resultados nunca são alterados nem
+ *	libertados antes de rc_free(), pelo que um resultado devolvido por
+ *	rc_find() pode ser lido fora do trinco.
+ *
+ *	O ficheiro (rc_read(), rc_write()) tem um bloco por tamanho de palavra,
+ *	com o checksum das palavras desse tamanho no dicionário: os índices dos
+ *	vértices só servem para o mesmo dicionário.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "result.h"
+#include "bool.h"
+#include "utils.h"
+#include "const.h"
+
+/* Identificação do ficheiro de resultados. */
+#define RC_MAGIC "WMRC1"
+/* Número máximo de resultados guardados; os seguintes são descartados. */
+#define MAX_RESULTS (1L << 20)
+
+/**
+ * @brief Resultado de um problema.
+ * @details next: resultado seguinte na mesma entrada da tabela
+ *	size, max_perm: tamanho de palavra e permutações do problema
+ *	a, b: vértices do problema, com a < b
+ *	length: número de vértices do caminho de a até b, 0 se não houver
+ *	cost: custo do caminho, ou NO_PATH
+ *	path: vértices do caminho, de a até b
+ */
+struct _Result {
+	struct _Result *next;
+	unsigned short size, max_perm, a, b, length;
+	int cost;
+	unsigned short *path;
+};
+
+static Result **table = NULL;
+static unsigned long buckets = 0;
+static long count = 0;
+
+/**
+ * @brief Função de dispersão da chave de um problema.
+ */
+static unsigned long rc_hash(int size, unsigned short max_perm,
+		unsigned short a, unsigned short b)
+{
+	unsigned long h = (unsigned long) size;
+
+	h = h * 31 + max_perm;
+	h = h * 65599 + a;
+	h = h * 65599 + b;
+
+	return h ^ (h >> 16);
+}
+
+/**
+ * @brief Procura o resultado com uma chave, já normalizada (a < b).
+ */
+static Result *rc_lookup(int size, unsigned short max_perm,
+		unsigned short a, unsigned short b)
+{
+	Result *r;
+
+	if (table == NULL) {
+		return NULL;
+	}
+	r = table[rc_hash(size, max_perm, a, b) & (buckets - 1)];
+	for (; r != NULL; r = r->next) {
+		if (r->a == a && r->b == b && r->size == size && r->max_perm == max_perm) {
+			return r;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Duplica o número de entradas da tabela.
+ */
+static void rc_grow(void)
+{
+	unsigned long n = buckets ? 2 * buckets : 1024, i, k;
+	Result **t = (Result **) ecalloc(n, sizeof(Result *));
+	Result *r, *next;
+
+	for (i = 0; i < buckets; i++) {
+		for (r = table[i]; r != NULL; r = next) {
+			next = r->next;
+			k = rc_hash(r->size, r->max_perm, r->a, r->b) & (n - 1);
+			r->next = t[k];
+			t[k] = r;
+		}
+	}
+
+	free(table);
+	table = t;
+	buckets = n;
+}
+
+/**
+ * @brief Liberta um resultado.
+ */
+static void rc_free_result(Result *r)
+{
+	free(r->path);
+	free(r);
+}
+
+/**
+ * @brief Insere um resultado, ou liberta-o se a chave já lá estiver ou a
+ *	cache estiver cheia.
+ */
+static void rc_insert(Result *r)
+{
+	unsigned long k;
+
+	if (count >= MAX_RESULTS || rc_lookup(r->size, r->max_perm, r->a, r->b) != NULL) {
+		rc_free_result(r);
+		return;
+	}
+	if ((unsigned long) count >= buckets) {
+		rc_grow();
+	}
+
+	k = rc_hash(r->size, r->max_perm, r->a, r->b) & (buckets - 1);
+	r->next = table[k];
+	table[k] = r;
+	count++;
+}
+
+/**
+ * @brief Cria um resultado, com espaço para o caminho.
+ */
+static Result *rc_new(int size, unsigned short max_perm, int src, int dst,
+		int cost, unsigned short length)
+{
+	Result *r = (Result *) emalloc(sizeof(Result));
+
+	r->size = (unsigned short) size;
+	r->max_perm = max_perm;
+	r->a = (unsigned short) (src < dst ? src : dst);
+	r->b = (unsigned short) (src < dst ? dst : src);
+	r->length = length;
+	r->cost = cost;
+	r->path = length > 0
+		? (unsigned short *) emalloc(length * sizeof(unsigned short)) : NULL;
+
+	return r;
+}
+
+/**
+ * @brief Procura o resultado de um problema, num sentido ou no outro.
+ *
+ * @param size Tamanho de palavra.
+ * @param max_perm Número máximo de permutações do problema.
+ * @param src Vértice de partida.
+ * @param dst Vértice de chegada.
+ * @return Resultado, ou NULL se o problema ainda não foi resolvido.
+ */
+const Result *rc_find(int size, unsigned short max_perm, int src, int dst)
+{
+	return rc_lookup(size, max_perm, (unsigned short) (src < dst ? src : dst),
+			(unsigned short) (src < dst ? dst : src));
+}
+
+/**
+ * @brief Guarda o resultado de um problema.
+ *
+ * @param size Tamanho de palavra.
+ * @param max_perm Número máximo de permutações do problema.
+ * @param src Vértice de partida.
+ * @param dst Vértice de chegada.
+ * @param cost Custo do caminho, ou NO_PATH (outros códigos não são
+ *	resultados e não devem ser guardados).
+ * @param path Árvore de caminho de src, com o caminho até dst (ignorada
+ *	se cost for NO_PATH).
+ */
+void rc_add(int size, unsigned short max_perm, int src, int dst, int cost,
+		const int *path)
+{
+	Result *r;
+	unsigned short length = 0;
+	int v, k;
+
+	if (cost >= 0) {
+		for (v = dst, length = 1; path[v] != -1; v = path[v]) {
+			length++;
+		}
+	}
+
+	r = rc_new(size, max_perm, src, dst, cost, length);
+	/* A árvore dá o caminho de dst para trás: guardá-lo de a para b. */
+	for (v = dst, k = 0; k < length; v = path[v], k++) {
+		r->path[src < dst ? length - 1 - k : k] = (unsigned short) v;
+	}
+
+	rc_insert(r);
+}
+
+/**
+ * @brief Custo de um resultado.
+ */
+int rc_cost(const Result *r)
+{
+	return r->cost;
+}
+
+/**
+ * @brief Número de vértices do caminho de um resultado, incluindo a partida
+ *	e a chegada; 0 se não houver caminho.
+ */
+int rc_length(const Result *r)
+{
+	return r->length;
+}
+
+/**
+ * @brief Vértice de um caminho, no sentido do problema.
+ *
+ * @param r Resultado.
+ * @param src Vértice de partida do problema (um dos dois do resultado).
+ * @param i Posição no caminho, de 0 (src) a rc_length(r) - 1.
+ * @return Índice do vértice.
+ */
+int rc_vertex(const Result *r, int src, int i)
+{
+	return src == r->a ? r->path[i] : r->path[r->length - 1 - i];
+}
+
+/**
+ * @brief Lê resultados guardados por rc_write().
+ * @details Se o ficheiro não existir não há nada a ler. Os blocos de
+ *	tamanhos de palavra cujo checksum não é o do dicionário atual são
+ *	ignorados.
+ *
+ * @param name Nome do ficheiro.
+ * @param checksum Checksum das palavras de cada tamanho do dicionário.
+ * @param words Número de palavras de cada tamanho do dicionário.
+ */
+void rc_read(const char *name, const unsigned long *checksum, const int *words)
+{
+	FILE *f;
+	char magic[sizeof(RC_MAGIC)];
+	unsigned short key[4]; /* max_perm, a, b, length */
+	unsigned long sum;
+	long n, j;
+	int size, cost, k;
+	bool block, valid, corrupt = false;
+	Result *r;
+
+	if ((f = fopen(name, "rb")) == NULL) {
+		return;
+	}
+
+	if (fread(magic, 1, sizeof(magic), f) != sizeof(magic)
+			|| memcmp(magic, RC_MAGIC, sizeof(magic)) != 0) {
+		fprintf(stderr, "Aviso: %s não é um ficheiro de resultados.\n", name);
+		fclose(f);
+		return;
+	}
+
+	/* Cada bloco: tamanho de palavra, checksum e número de resultados. */
+	while (!corrupt && fread(&size, sizeof(int), 1, f) == 1) {
+		if (size <= 0 || size >= MAX_WORD_SIZE
+				|| fread(&sum, sizeof(unsigned long), 1, f) != 1
+				|| fread(&n, sizeof(long), 1, f) != 1 || n < 0) {
+			corrupt = true;
+			break;
+		}
+		block = sum == checksum[size] && words[size] > 0;
+
+		for (j = 0; j < n; j++) {
+			if (fread(key, sizeof(unsigned short), 4, f) != 4
+					|| fread(&cost, sizeof(int), 1, f) != 1
+					|| key[1] >= key[2] || (cost >= 0) != (key[3] > 0)) {
+				corrupt = true;
+				break;
+			}
+			r = rc_new(size, key[0], key[1], key[2], cost, key[3]);
+			if (fread(r->path, sizeof(unsigned short), key[3], f) != key[3]) {
+				rc_free_result(r);
+				corrupt = true;
+				break;
+			}
+
+			/* Os vértices têm de existir no grafo deste dicionário. */
+			valid = block;
+			for (k = 0; valid && k < key[3]; k++) {
+				valid = r->path[k] < words[size];
+			}
+			if (valid && key[2] < words[size] && (key[3] == 0
+					|| (r->path[0] == key[1] && r->path[key[3] - 1] == key[2]))) {
+				rc_insert(r);
+			}
+			else {
+				rc_free_result(r);
+			}
+		}
+	}
+
+	if (corrupt) {
+		fprintf(stderr, "Aviso: %s está corrompido.\n", name);
+	}
+	fclose(f);
+}
+
+/**
+ * @brief Guarda todos os resultados num ficheiro.
+ *
+ * @param name Nome do ficheiro.
+ * @param checksum Checksum das palavras de cada tamanho do dicionário.
+ */
+void rc_write(const char *name, const unsigned long *checksum)
+{
+	FILE *f = efopen(name, "wb");
+	unsigned short key[4];
+	unsigned long i;
+	long n;
+	int size;
+	Result *r;
+
+	fwrite(RC_MAGIC, 1, sizeof(RC_MAGIC), f);
+	for (size = 1; size < MAX_WORD_SIZE; size++) {
+		n = 0;
+		for (i = 0; i < buckets; i++) {
+			for (r = table[i]; r != NULL; r = r->next) {
+				n += r->size == size;
+			}
+		}
+		if (n == 0) {
+			continue;
+		}
+
+		fwrite(&size, sizeof(int), 1, f);
+		fwrite(&checksum[size], sizeof(unsigned long), 1, f);
+		fwrite(&n, sizeof(long), 1, f);
+		for (i = 0; i < buckets; i++) {
+			for (r = table[i]; r != NULL; r = r->next) {
+				if (r->size != size) {
+					continue;
+				}
+				key[0] = r->max_perm;
+				key[1] = r->a;
+				key[2] = r->b;
+				key[3] = r->length;
+				fwrite(key, sizeof(unsigned short), 4, f);
+				fwrite(&r->cost, sizeof(int), 1, f);
+				fwrite(r->path, sizeof(unsigned short), r->length, f);
+			}
+		}
+	}
+
+	fclose(f);
+}
+
+/**
+ * @brief Liberta todos os resultados.
+ */
+void rc_free(void)
+{
+	unsigned long i;
+	Result *r, *next;
+
+	for (i = 0; i < buckets; i++) {
+		for (r = table[i]; r != NULL; r = next) {
+			next = r->next;
+			rc_free_result(r);
+		}
+	}
+
+	free(table);
+	table = NULL;
+	buckets = 0;
+	count = 0;
+}
@@ -0,0 +1,29 @@
+/**
+ * @file result.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Cache de resultados de problemas (--result-cache).
+ * @details
+ *	Guarda o custo e o caminho, em índices de vértices, de cada problema
+ *	resolvido, pela chave (tamanho de palavra, permutações, par de
+ *	vértices sem ordem): os grafos não são dirigidos, pelo que o caminho
+ *	de a para b, ao contrário, serve de b para a.
+ */
+#ifndef _RESULT_H
+#define _RESULT_H
+
+typedef struct _Result Result;
+
+const Result *rc_find(int size, unsigned short max_perm, int src, int dst);
+void rc_add(int size, unsigned short max_perm, int src, int dst, int cost,
+		const int *path);
+int rc_cost(const Result *r);
+int rc_length(const Result *r);
+int rc_vertex(const Result *r, int src, int i);
+void rc_read(const char *name, const unsigned long *checksum, const int *words);
+void rc_write(const char *name, const unsigned long *checksum);
+void rc_free(void);
+
+#endif
@@ -0,0 +1,428 @@
+/**
+ * @file stats.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Estatísticas de execução (--stats).
+ * @details
+ *	O relatório é escrito no fim da execução: em texto para o stderr, ou
+ *	em JSON para o ficheiro dado em --stats=ficheiro.
+ *
+ *	O RSS é lido de /proc/self/status (Linux); noutros sistemas fica a 0.
+ *
+ *	Os contadores de cada pesquisa são guardados para o relatório mostrar
+ *	os percentis 50, 90, 99 e o máximo; com --query-csv=ficheiro, cada
+ *	linha do .pal dá também uma linha CSV, escrita logo que é resolvida.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stats.h"
+#include "const.h"
+#include "options.h"
+#include "utils.h"
+
+/* Número máximo de fases e de fases abertas em simultâneo. */
+#define MAX_PHASES 256
+#define MAX_DEPTH 16
+
+/**
+ * @brief Registo de uma fase.
+ * @details depth: nível de encaixe (0 para fases de topo)
+ *	seconds: duração
+ *	alloc: bytes pedidos a emalloc()/ecalloc() durante a fase
+ *	rss_before, rss_after: RSS do processo, em KB, no início e no fim
+ */
+typedef struct _Phase {
+	const char *name;
+	int depth;
+	double start;
+	double seconds;
+	unsigned long alloc;
+	long rss_before;
+	long rss_after;
+} Phase;
+
+/**
+ * @brief Registo de um grafo.
+ */
+typedef struct _GraphStats {
+	int word_size;
+	unsigned short vertices;
+	unsigned long edges;
+	size_t bytes;
+	double seconds;
+} GraphStats;
+
+static Phase phases[MAX_PHASES];
+static int num_phases = 0;
+/* Índices em phases das fases ainda abertas. */
+static int open_phases[MAX_DEPTH];
+static int depth = 0;
+
+static GraphStats graphs[MAX_WORD_SIZE];
+static int num_graphs = 0;
+
+/**
+ * @brief Registo de uma pesquisa.
+ */
+typedef struct _QueryStats {
+	Counters cnt;
+	double seconds;
+} QueryStats;
+
+/* Número de medidas de cada pesquisa (tempo e os sete contadores). */
+#define NUM_MEASURES 8
+static const char *measure_names[NUM_MEASURES] = {
+	"microseconds", "settled", "scanned", "filtered",
+	"inserts", "decreases", "pops", "stale"
+};
+
+static QueryStats *queries = NULL;
+static long num_queries = 0;
+static long max_queries = 0;
+
+static FILE *csv = NULL;
+
+/**
+ * @brief Lê um campo de /proc/self/status.
+ *
+ * @param key Nome do campo, incluindo ':' (p.e. "VmRSS:").
+ * @return Valor do campo em KB, ou 0 se não estiver disponível.
+ */
+static long proc_status_kb(const char *key)
+{
+	FILE *f;
+	char line[128];
+	size_t len = strlen(key);
+	long kb = 0;
+
+	if ((f = fopen("/proc/self/status", "r")) == NULL) {
+		return 0;
+	}
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (strncmp(line, key, len) == 0) {
+			kb = atol(line + len);
+			break;
+		}
+	}
+	fclose(f);
+
+	return kb;
+}
+
+/**
+ * @brief Início de uma fase.
+ *
+ * @param name Nome da fase (string constante).
+ */
+void st_begin(const char *name)
+{
+	Phase *p;
+
+	if (!options.stats) {
+		return;
+	}
+	if (num_phases == MAX_PHASES || depth == MAX_DEPTH) {
+		/* Marca a fase como não registada, para st_end(). */
+		if (depth < MAX_DEPTH) {
+			open_phases[depth] = -1;
+		}
+		depth++;
+		return;
+	}
+
+	p = &phases[num_phases];
+	p->name = name;
+	p->depth = depth;
+	p->rss_before = proc_status_kb("VmRSS:");
+	p->alloc = alloc_bytes();
+	p->start = mono_time();
+
+	open_phases[depth++] = num_phases++;
+}
+
+/**
+ * @brief Fim da fase aberta mais recentemente.
+ */
+void st_end(void)
+{
+	Phase *p;
+	double now;
+
+	if (!options.stats || depth == 0) {
+		return;
+	}
+	now = mono_time();
+	depth--;
+	if (depth >= MAX_DEPTH || open_phases[depth] < 0) {
+		return;
+	}
+
+	p = &phases[open_phases[depth]];
+	p->seconds = now - p->start;
+	p->alloc = alloc_bytes() - p->alloc;
+	p->rss_after = proc_status_kb("VmRSS:");
+}
+
+/**
+ * @brief Regista um grafo depois de construídas as suas arestas.
+ *
+ * @param word_size Tamanho das palavras do grafo.
+ * @param g Ponteiro para grafo.
+ * @param seconds Tempo de construção das arestas.
+ */
+void st_graph(int word_size, Graph *g, double seconds)
+{
+	GraphStats *s;
+
+	if (!options.stats || num_graphs == MAX_WORD_SIZE) {
+		return;
+	}
+
+	s = &graphs[num_graphs++];
+	s->word_size = word_size;
+	s->vertices = g_get_size(g);
+	s->edges = g_get_edges(g);
+	/* Além da estrutura, cada vértice guarda uma palavra. */
+	s->bytes = g_get_bytes(g) + (size_t) s->vertices * (word_size + 1);
+	s->seconds = seconds;
+}
+
+/**
+ * @brief Regista uma linha do .pal depois de resolvida.
+ * @details Só as linhas resolvidas por pesquisa entram nos percentis; as
+ *	triviais e as marcadas pelo prazo do lote aparecem apenas no CSV.
+ *
+ * @param word1 Palavra de partida.
+ * @param word2 Palavra de chegada.
+ * @param max_perm Número máximo de permutações por passo.
+ * @param cost Custo do caminho ou código de erro (const.h).
+ * @param cnt Contadores da pesquisa, NULL se não houve pesquisa.
+ * @param seconds Duração da pesquisa.
+ */
+void st_query(const char *word1, const char *word2, int max_perm, int cost,
+		const Counters *cnt, double seconds)
+{
+	static const Counters none = {0, 0, 0, 0, 0, 0, 0};
+	QueryStats *q;
+
+	if (options.query_csv != NULL) {
+		if (csv == NULL) {
+			csv = efopen(options.query_csv, "w");
+			fprintf(csv, "word1,word2,max_perm,cost,%s,%s,%s,%s,%s,%s,%s,%s\n",
+				measure_names[1], measure_names[2], measure_names[3],
+				measure_names[4], measure_names[5], measure_names[6],
+				measure_names[7], measure_names[0]);
+		}
+		if (cnt == NULL) {
+			cnt = &none;
+			seconds = 0;
+		}
+		fprintf(csv, "%s,%s,%d,%d,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%.0f\n",
+			word1, word2, max_perm, cost, cnt->settled, cnt->scanned,
+			cnt->filtered, cnt->inserts, cnt->decreases, cnt->pops,
+			cnt->stale, seconds * 1e6);
+		if (cnt == &none) {
+			return;
+		}
+	}
+
+	if (!options.stats || cnt == NULL) {
+		return;
+	}
+
+	if (num_queries == max_queries) {
+		max_queries = max_queries ? 2 * max_queries : 1024;
+		queries = erealloc(queries, max_queries * sizeof(QueryStats));
+	}
+	q = &queries[num_queries++];
+	q->cnt = *cnt;
+	q->seconds = seconds;
+}
+
+/**
+ * @brief Valor de uma medida de uma pesquisa.
+ *
+ * @param q Registo da pesquisa.
+ * @param m Índice da medida em measure_names.
+ * @return Valor da medida.
+ */
+static double measure(QueryStats *q, int m)
+{
+	switch (m) {
+	case 0: return q->seconds * 1e6;
+	case 1: return q->cnt.settled;
+	case 2: return q->cnt.scanned;
+	case 3: return q->cnt.filtered;
+	case 4: return q->cnt.inserts;
+	case 5: return q->cnt.decreases;
+	case 6: return q->cnt.pops;
+	default: return q->cnt.stale;
+	}
+}
+
+/**
+ * @brief Função comparadora de doubles para qsort().
+ */
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *((const double *) a), y = *((const double *) b);
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Percentis 50, 90, 99 e máximo de uma medida das pesquisas.
+ *
+ * @param m Índice da medida em measure_names.
+ * @param sorted Tabela auxiliar com espaço para num_queries valores.
+ * @param out Onde escrever os quatro valores.
+ */
+static void percentiles(int m, double *sorted, double out[4])
+{
+	static const double p[3] = {0.50, 0.90, 0.99};
+	long i, rank;
+
+	for (i = 0; i < num_queries; i++) {
+		sorted[i] = measure(&queries[i], m);
+	}
+	qsort(sorted, num_queries, sizeof(double), cmp_double);
+
+	/* Percentil pelo método da ordem mais próxima. */
+	for (i = 0; i < 3; i++) {
+		rank = (long) (p[i] * num_queries + 0.999999);
+		out[i] = sorted[rank > 0 ? rank - 1 : 0];
+	}
+	out[3] = sorted[num_queries - 1];
+}
+
+/**
+ * @brief Escreve o relatório em texto.
+ *
+ * @param f Ficheiro de saída.
+ */
+static void report_text(FILE *f)
+{
+	int i, m;
+	Phase *p;
+	GraphStats *s;
+	double *sorted;
+	double pct[4];
+
+	fprintf(f, "%-28s %12s %14s %10s %10s\n",
+		"fase", "tempo (s)", "alocado (KB)", "RSS (KB)", "dRSS (KB)");
+	for (i = 0; i < num_phases; i++) {
+		p = &phases[i];
+		fprintf(f, "%*s%-*s %12.6f %14lu %10ld %+10ld\n",
+			2 * p->depth, "", 28 - 2 * p->depth, p->name,
+			p->seconds, p->alloc / 1024,
+			p->rss_after, p->rss_after - p->rss_before);
+	}
+
+	/* Cabeçalho escrito à mão: os acentos estragam o alinhamento de %s. */
+	fprintf(f, "\ngrafo      vértices      arestas   memória (KB)    arestas (s)\n");
+	for (i = 0; i < num_graphs; i++) {
+		s = &graphs[i];
+		fprintf(f, "%-8d %10u %12lu %14lu %14.6f\n", s->word_size,
+			s->vertices, s->edges, (unsigned long) (s->bytes / 1024),
+			s->seconds);
+	}
+
+	if (num_queries > 0) {
+		sorted = (double *) emalloc(num_queries * sizeof(double));
+		fprintf(f, "\n%ld pesquisas (fila %s)\n%-14s %12s %12s %12s %12s\n",
+			num_queries, sp_queue_name(options.queue),
+			"medida", "p50", "p90", "p99", "máx");
+		for (m = 0; m < NUM_MEASURES; m++) {
+			percentiles(m, sorted, pct);
+			fprintf(f, "%-14s %12.0f %12.0f %12.0f %12.0f\n",
+				measure_names[m], pct[0], pct[1], pct[2], pct[3]);
+		}
+		free(sorted);
+	}
+
+	fprintf(f, "\npico de RSS: %ld KB\n", proc_status_kb("VmHWM:"));
+}
+
+/**
+ * @brief Escreve o relatório em JSON.
+ *
+ * @param f Ficheiro de saída.
+ */
+static void report_json(FILE *f)
+{
+	int i, m;
+	Phase *p;
+	GraphStats *s;
+	double *sorted;
+	double pct[4];
+
+	fprintf(f, "{\n  \"phases\": [");
+	for (i = 0; i < num_phases; i++) {
+		p = &phases[i];
+		fprintf(f, "%s\n    {\"name\": \"%s\", \"depth\": %d, "
+			"\"seconds\": %.6f, \"alloc_bytes\": %lu, "
+			"\"rss_kb_before\": %ld, \"rss_kb_after\": %ld}",
+			i ? "," : "", p->name, p->depth, p->seconds, p->alloc,
+			p->rss_before, p->rss_after);
+	}
+
+	fprintf(f, "\n  ],\n  \"graphs\": [");
+	for (i = 0; i < num_graphs; i++) {
+		s = &graphs[i];
+		fprintf(f, "%s\n    {\"word_size\": %d, \"vertices\": %u, "
+			"\"edges\": %lu, \"bytes\": %lu, \"seconds\": %.6f}",
+			i ? "," : "", s->word_size, s->vertices, s->edges,
+			(unsigned long) s->bytes, s->seconds);
+	}
+
+	fprintf(f, "\n  ],\n  \"queries\": {\"count\": %ld, \"queue\": \"%s\"",
+		num_queries, sp_queue_name(options.queue));
+	if (num_queries > 0) {
+		sorted = (double *) emalloc(num_queries * sizeof(double));
+		for (m = 0; m < NUM_MEASURES; m++) {
+			percentiles(m, sorted, pct);
+			fprintf(f, ",\n    \"%s\": {\"p50\": %.0f, \"p90\": %.0f, "
+				"\"p99\": %.0f, \"max\": %.0f}", measure_names[m],
+				pct[0], pct[1], pct[2], pct[3]);
+		}
+		free(sorted);
+	}
+
+	fprintf(f, "},\n  \"peak_rss_kb\": %ld\n}\n",
+		proc_status_kb("VmHWM:"));
+}
+
+/**
+ * @brief Escreve o relatório de estatísticas.
+ * @details Para o stderr, ou para o ficheiro options.stats_file em JSON.
+ *	Fecha também o ficheiro CSV das pesquisas.
+ */
+void st_report(void)
+{
+	FILE *f;
+
+	if (csv != NULL) {
+		fclose(csv);
+		csv = NULL;
+	}
+	if (!options.stats) {
+		return;
+	}
+
+	if (options.stats_file == NULL) {
+		report_text(stderr);
+	}
+	else {
+		f = efopen(options.stats_file, "w");
+		report_json(f);
+		fclose(f);
+	}
+
+	free(queries);
+	queries = NULL;
+	num_queries = max_queries = 0;
+}
@@ -0,0 +1,34 @@
+/**
+ * @file stats.h
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Estatísticas de execução (--stats).
+ * @details
+ *	Cada fase do programa é delimitada por st_begin() e st_end(); para
+ *	cada uma regista-se o tempo (relógio monotónico), a memória pedida a
+ *	emalloc()/ecalloc() e o RSS do processo antes e depois. As fases podem
+ *	estar encaixadas (p.e. lm_build dentro de solve_pal).
+ *
+ *	Para cada grafo regista-se o número de vértices, arestas, memória e
+ *	tempo de construção das arestas, e para cada problema os contadores da
+ *	pesquisa que o resolveu.
+ *
+ *	Sem as opções --stats e --query-csv, todas as funções retornam de
+ *	imediato.
+ */
+#ifndef _STATS_H
+#define _STATS_H
+
+#include "graph.h"
+#include "dijkstra.h"
+
+void st_begin(const char *name);
+void st_end(void);
+void st_graph(int word_size, Graph *g, double seconds);
+void st_query(const char *word1, const char *word2, int max_perm, int cost,
+		const Counters *cnt, double seconds);
+void st_report(void);
+
+#endif
@@ -7,17 +7,32 @@
  * @brief Funções de utilidade genérica.
  * @details
  * 	Wrappers de funções com verificação de erros:
- * 		emalloc(), ecalloc(), efopen()
+ * 		emalloc(), ecalloc(), erealloc(), efopen()
  *
  * 	Manipulação de strings:
  * 		change_file_ext()
+ *
+ * 	Tempo e memória:
+ * 		mono_time(), alloc_bytes()
  */
+/* clock_gettime() e os trincos de fios de execução são POSIX, não fazem
+ * parte de C89. */
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <pthread.h>
 
 #include "utils.h"
 
+/* Total de bytes pedidos a emalloc(), ecalloc() e erealloc() desde o
+ * início. Nos modos com vários fios de execução todos alocam, daí o
+ * trinco. */
+static unsigned long allocated = 0;
+static pthread_mutex_t allocated_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /**
  * @brief Wrapper da função malloc() com verificação de erros.
  *
@@ -31,6 +46,9 @@ void *emalloc(const size_t size)
 		fprintf(stderr, "Erro: impossível alocar memória.\n");
 		exit(EXIT_FAILURE);
 	}
+	pthread_mutex_lock(&allocated_lock);
+	allocated += size;
+	pthread_mutex_unlock(&allocated_lock);
 	return p;
 }
 
@@ -48,6 +66,31 @@ void *ecalloc(const size_t nmemb, const size_t size)
 		fprintf(stderr, "Erro: impossível alocar memória.\n");
 		exit(EXIT_FAILURE);
 	}
+	pthread_mutex_lock(&allocated_lock);
+	allocated += nmemb * size;
+	pthread_mutex_unlock(&allocated_lock);
+	return p;
+}
+
+/**
+ * @brief Wrapper da função realloc() com verificação de erros.
+ * @details Conta os size bytes pedidos como uma nova alocação: num vector
+ *	que duplica, o total fica até duas vezes a capacidade final.
+ *
+ * @param p Bloco a redimensionar, ou NULL.
+ * @param size Novo tamanho em bytes.
+ * @return Ponteiro para a memória realocada.
+ */
+void *erealloc(void *p, const size_t size)
+{
+	p = realloc(p, size);
+	if (p == NULL) {
+		fprintf(stderr, "Erro: impossível alocar memória.\n");
+		exit(EXIT_FAILURE);
+	}
+	pthread_mutex_lock(&allocated_lock);
+	allocated += size;
+	pthread_mutex_unlock(&allocated_lock);
 	return p;
 }
 
@@ -91,3 +134,35 @@ char *change_file_ext(const char *orig_file_name, const char *new_ext)
 
 	return new_file_name;
 }
+
+/**
+ * @brief Tempo de um relógio monotónico.
+ * @details Ao contrário do relógio de parede, não recua nem salta com
+ *	acertos de hora, pelo que serve para medir intervalos e prazos.
+ *
+ * @return Segundos desde um instante arbitrário (fixo durante a execução).
+ */
+double mono_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Total de memória alocada com emalloc(), ecalloc() e erealloc().
+ * @details Só conta alocações, não libertações; a diferença entre duas
+ *	leituras dá a memória pedida por uma fase do programa.
+ *
+ * @return Número de bytes alocados desde o início do programa.
+ */
+unsigned long alloc_bytes(void)
+{
+	unsigned long n;
+
+	pthread_mutex_lock(&allocated_lock);
+	n = allocated;
+	pthread_mutex_unlock(&allocated_lock);
+	return n;
+}
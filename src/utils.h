@@ -7,10 +7,13 @@
  * @brief Funções de utilidade genérica.
  * @details
  * 	Wrappers de funções com verificação de erros:
- * 		emalloc(), ecalloc(), efopen()
+ * 		emalloc(), ecalloc(), erealloc(), efopen()
  *
  * 	Manipulação de strings:
  * 		change_file_ext()
+ *
+ * 	Tempo e memória:
+ * 		mono_time(), alloc_bytes()
  */
 #ifndef _UTILS_H
 #define _UTILS_H
@@ -19,7 +22,10 @@
 
 void *emalloc(const size_t size);
 void *ecalloc(const size_t nmemb, const size_t size);
+void *erealloc(void *p, const size_t size);
 FILE *efopen(const char *filename, const char *mode);
 char *change_file_ext(const char *orig_file_name, const char *new_ext);
+double mono_time(void);
+unsigned long alloc_bytes(void);
 
 #endif
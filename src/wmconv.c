@@ -0,0 +1,337 @@
+/**
+ * @file wmconv.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Conversor entre os formatos de texto e binário (ver binio.h).
+ * @details
+ *	pal2bin e bin2pal convertem ficheiros de problemas. path2bin e bin2path
+ *	convertem ficheiros de resultados; como o formato binário guarda
+ *	índices de vértices e não palavras, precisam do dicionário e dos
+ *	problemas (.pal ou .bpal) que deram origem aos resultados.
+ *
+ *	Utilização:
+ *		wmconv pal2bin problemas.pal problemas.bpal
+ *		wmconv bin2pal problemas.bpal problemas.pal
+ *		wmconv path2bin dicionário.dic problemas.pal|.bpal res.path res.bpath
+ *		wmconv bin2path dicionário.dic problemas.pal|.bpal res.bpath res.path
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bool.h"
+#include "const.h"
+#include "utils.h"
+#include "word.h"
+#include "binio.h"
+
+/**
+ * @brief Uma palavra do dicionário e o seu índice entre as palavras do
+ *	mesmo tamanho.
+ */
+typedef struct _DicWord {
+	char *word;
+	unsigned short index;
+} DicWord;
+
+/* Palavras de cada tamanho, pela ordem do dicionário e ordenadas. */
+static char **dic_words[MAX_WORD_SIZE];
+static DicWord *dic_sorted[MAX_WORD_SIZE];
+static int dic_count[MAX_WORD_SIZE];
+
+/**
+ * @brief Comparador para qsort() e bsearch(): ordem alfabética.
+ */
+static int dw_cmp(const void *a, const void *b)
+{
+	return strcmp(((const DicWord *) a)->word, ((const DicWord *) b)->word);
+}
+
+/**
+ * @brief Lê o dicionário como o wordmorph: por tamanho de palavra, pela
+ *	ordem do ficheiro.
+ *
+ * @param name Nome do ficheiro.
+ */
+static void read_dic(const char *name)
+{
+	FILE *f = efopen(name, "r");
+	char buffer[MAX_WORD_SIZE];
+	int len, i;
+
+	while (fscanf(f, "%63s", buffer) == 1) {
+		dic_count[strlen(buffer)]++;
+	}
+	for (len = 0; len < MAX_WORD_SIZE; len++) {
+		if (dic_count[len] > MAX_VERTICES) {
+			fprintf(stderr, "Erro: %d palavras de tamanho %d, o máximo é %d.\n",
+				dic_count[len], len, MAX_VERTICES);
+			exit(EXIT_FAILURE);
+		}
+		dic_words[len] = (char **) emalloc((dic_count[len] + 1) * sizeof(char *));
+		dic_sorted[len] = (DicWord *) emalloc((dic_count[len] + 1) * sizeof(DicWord));
+		dic_count[len] = 0;
+	}
+
+	rewind(f);
+	while (fscanf(f, "%63s", buffer) == 1) {
+		len = strlen(buffer);
+		i = dic_count[len]++;
+		dic_words[len][i] = (char *) emalloc(len + 1);
+		strcpy(dic_words[len][i], buffer);
+		dic_sorted[len][i].word = dic_words[len][i];
+		dic_sorted[len][i].index = (unsigned short) i;
+	}
+	fclose(f);
+
+	for (len = 0; len < MAX_WORD_SIZE; len++) {
+		qsort(dic_sorted[len], dic_count[len], sizeof(DicWord), dw_cmp);
+	}
+}
+
+/**
+ * @brief Procura uma palavra no dicionário.
+ *
+ * @return Índice da palavra entre as do mesmo tamanho, ou -1 se não existir.
+ */
+static int dic_index(char *word)
+{
+	DicWord key, *found;
+	size_t len = strlen(word);
+
+	key.word = word;
+	found = (DicWord *) bsearch(&key, dic_sorted[len], dic_count[len],
+		sizeof(DicWord), dw_cmp);
+
+	return found != NULL ? found->index : -1;
+}
+
+/**
+ * @brief Abre um ficheiro de problemas, em texto ou em binário consoante a
+ *	extensão.
+ *
+ * @param name Nome do ficheiro.
+ * @param binary Onde guardar se o ficheiro é binário.
+ * @return Ficheiro, pronto a ler o primeiro problema.
+ */
+static FILE *open_pal(const char *name, bool *binary)
+{
+	const char *ext = strrchr(name, '.');
+	FILE *f = efopen(name, "rb");
+
+	*binary = ext != NULL && strcmp(ext, BIN_PAL_EXT) == 0;
+	if (*binary && !bin_check_magic(f, PAL_MAGIC)) {
+		fprintf(stderr, "Erro: %s não é um ficheiro de problemas binário.\n", name);
+		exit(EXIT_FAILURE);
+	}
+
+	return f;
+}
+
+/**
+ * @brief Lê o problema seguinte de um ficheiro aberto com open_pal().
+ *
+ * @return Verdadeiro se leu um problema, falso no fim do ficheiro.
+ */
+static bool read_problem(FILE *f, bool binary, char *word1, char *word2,
+		unsigned short *max_perm)
+{
+	int r;
+
+	if (!binary) {
+		return fscanf(f, "%63s %63s %hu", word1, word2, max_perm) == 3;
+	}
+	if ((r = bin_read_problem(f, word1, word2, max_perm)) < 0) {
+		fprintf(stderr, "Erro: ficheiro de problemas corrompido.\n");
+		exit(EXIT_FAILURE);
+	}
+	return r == 1;
+}
+
+/**
+ * @brief Verifica se o wordmorph escreve o resultado de um problema sem
+ *	caminho: custo negativo ou problema trivial.
+ */
+static bool no_vertices(char *word1, char *word2, int cost)
+{
+	return cost < 0 || strlen(word1) != strlen(word2)
+		|| w_diff((Item) word1, (Item) word2, 1) <= 1;
+}
+
+/**
+ * @brief Converte um .pal num .bpal.
+ */
+static void pal2bin(const char *in, const char *out)
+{
+	FILE *fin = efopen(in, "r");
+	FILE *fout = efopen(out, "wb");
+	char word1[MAX_WORD_SIZE], word2[MAX_WORD_SIZE];
+	unsigned short max_perm;
+
+	bin_write_magic(fout, PAL_MAGIC);
+	while (fscanf(fin, "%63s %63s %hu", word1, word2, &max_perm) == 3) {
+		bin_write_problem(fout, word1, word2, max_perm);
+	}
+	fclose(fin);
+	fclose(fout);
+}
+
+/**
+ * @brief Converte um .bpal num .pal.
+ */
+static void bin2pal(const char *in, const char *out)
+{
+	bool binary;
+	FILE *fin = open_pal(in, &binary);
+	FILE *fout = efopen(out, "w");
+	char word1[MAX_WORD_SIZE], word2[MAX_WORD_SIZE];
+	unsigned short max_perm;
+
+	while (read_problem(fin, binary, word1, word2, &max_perm)) {
+		fprintf(fout, "%s %s %hu\n", word1, word2, max_perm);
+	}
+	fclose(fin);
+	fclose(fout);
+}
+
+/**
+ * @brief Converte um .path num .bpath.
+ */
+static void path2bin(const char *pal, const char *in, const char *out)
+{
+	bool binary;
+	FILE *fpal = open_pal(pal, &binary);
+	FILE *fin = efopen(in, "r");
+	FILE *fout = efopen(out, "wb");
+	OutBuf *b = ob_init();
+	char word1[MAX_WORD_SIZE], word2[MAX_WORD_SIZE], buffer[MAX_WORD_SIZE];
+	char line[2 * MAX_WORD_SIZE];
+	unsigned short path[MAX_VERTICES];
+	unsigned short max_perm;
+	int cost, n, v, i;
+
+	bin_write_magic(fout, PATH_MAGIC);
+	while (read_problem(fpal, binary, word1, word2, &max_perm)) {
+		/* "word cost" e depois uma palavra por linha, até à linha vazia. */
+		if (fgets(line, sizeof(line), fin) == NULL
+				|| sscanf(line, "%63s %d", buffer, &cost) != 2) {
+			fprintf(stderr, "Erro: %s tem menos blocos que problemas.\n", in);
+			exit(EXIT_FAILURE);
+		}
+		n = 0;
+		do {
+			if (n == MAX_VERTICES) {
+				fprintf(stderr, "Erro: caminho demasiado longo em %s.\n", in);
+				exit(EXIT_FAILURE);
+			}
+			v = dic_index(buffer);
+			if (v < 0 && !no_vertices(word1, word2, cost)) {
+				fprintf(stderr, "Erro: %s não está no dicionário.\n", buffer);
+				exit(EXIT_FAILURE);
+			}
+			path[n++] = (unsigned short) v;
+		} while (fgets(line, sizeof(line), fin) != NULL
+			&& sscanf(line, "%63s", buffer) == 1);
+
+		if (no_vertices(word1, word2, cost)) {
+			n = 0;
+		}
+		bin_put_result(b, cost, n);
+		for (i = 0; i < n; i++) {
+			bin_put_vertex(b, path[i]);
+		}
+		ob_write(b, fout);
+	}
+
+	ob_free(b);
+	fclose(fpal);
+	fclose(fin);
+	fclose(fout);
+}
+
+/**
+ * @brief Converte um .bpath num .path.
+ */
+static void bin2path(const char *pal, const char *in, const char *out)
+{
+	bool binary;
+	FILE *fpal = open_pal(pal, &binary);
+	FILE *fin = efopen(in, "rb");
+	FILE *fout = efopen(out, "w");
+	char word1[MAX_WORD_SIZE], word2[MAX_WORD_SIZE];
+	unsigned short path[MAX_VERTICES];
+	unsigned short max_perm;
+	int cost, n, i;
+	size_t len;
+
+	if (!bin_check_magic(fin, PATH_MAGIC)) {
+		fprintf(stderr, "Erro: %s não é um ficheiro de resultados binário.\n", in);
+		exit(EXIT_FAILURE);
+	}
+	while (read_problem(fpal, binary, word1, word2, &max_perm)) {
+		if ((n = bin_read_result(fin, &cost, path, MAX_VERTICES)) < 0) {
+			fprintf(stderr, "Erro: %s tem menos resultados que problemas.\n", in);
+			exit(EXIT_FAILURE);
+		}
+		if (n == 0) {
+			fprintf(fout, "%s %d\n%s\n\n", word1, cost, word2);
+			continue;
+		}
+
+		len = strlen(word1);
+		for (i = 0; i < n; i++) {
+			if (path[i] >= dic_count[len]) {
+				fprintf(stderr, "Erro: vértice %hu fora do dicionário.\n", path[i]);
+				exit(EXIT_FAILURE);
+			}
+		}
+		fprintf(fout, "%s %d\n", dic_words[len][path[0]], cost);
+		for (i = 1; i < n; i++) {
+			fprintf(fout, "%s\n", dic_words[len][path[i]]);
+		}
+		fputc('\n', fout);
+	}
+
+	fclose(fpal);
+	fclose(fin);
+	fclose(fout);
+}
+
+/**
+ * @brief Mostra como usar o programa.
+ */
+static void conv_usage(const char *prog)
+{
+	fprintf(stderr, "Utilização:\n"
+		"  %s pal2bin problemas.pal problemas.bpal\n"
+		"  %s bin2pal problemas.bpal problemas.pal\n"
+		"  %s path2bin dicionário.dic problemas.pal|.bpal res.path res.bpath\n"
+		"  %s bin2path dicionário.dic problemas.pal|.bpal res.bpath res.path\n",
+		prog, prog, prog, prog);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc == 4 && strcmp(argv[1], "pal2bin") == 0) {
+		pal2bin(argv[2], argv[3]);
+	}
+	else if (argc == 4 && strcmp(argv[1], "bin2pal") == 0) {
+		bin2pal(argv[2], argv[3]);
+	}
+	else if (argc == 6 && strcmp(argv[1], "path2bin") == 0) {
+		read_dic(argv[2]);
+		path2bin(argv[3], argv[4], argv[5]);
+	}
+	else if (argc == 6 && strcmp(argv[1], "bin2path") == 0) {
+		read_dic(argv[2]);
+		bin2path(argv[3], argv[4], argv[5]);
+	}
+	else {
+		conv_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
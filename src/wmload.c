@@ -0,0 +1,260 @@
+/**
+ * @file wmload.c
+ * @authors João Pinheiro <joao.castro.pinheiro@tecnico.ulisboa.pt>
+ * @authors João Freitas <joao.m.freitas@tecnico.ulisboa.pt>
+ * @date 14 Dezembro 2016
+ *
+ * @brief Gerador de carga para o modo daemon (wordmorph --socket).
+ * @details
+ *	Abre várias ligações ao daemon ao mesmo tempo; cada cliente envia
+ *	problemas de um .pal, um de cada vez, esperando pela resposta antes de
+ *	enviar o seguinte (ciclo fechado). No fim mostra o débito total e os
+ *	percentis da latência de cada problema, e quantas respostas tiveram
+ *	cada tipo de custo.
+ *
+ *	Cada cliente começa numa linha diferente do .pal e dá a volta ao
+ *	ficheiro, para que os clientes não peçam todos o mesmo problema ao
+ *	mesmo tempo.
+ *
+ *	Utilização: wmload [--clients=N] [--requests=N] socket problemas.pal
+ */
+/* Sockets e fios de execução são POSIX, não fazem parte de C89. */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "bool.h"
+#include "const.h"
+#include "utils.h"
+
+/* Número máximo de clientes. */
+#define MAX_CLIENTS 1024
+
+/**
+ * @brief Um cliente.
+ * @details thread: fio de execução do cliente
+ *	first: primeira linha do .pal que envia
+ *	latency: segundos de cada problema
+ *	done: problemas respondidos
+ *	ok, no_path, budget, invalid: respostas com caminho, sem caminho,
+ *	com o orçamento esgotado e com a linha inválida
+ *	failed: verdadeiro se a ligação falhou
+ */
+typedef struct _Client {
+	pthread_t thread;
+	long first;
+	double *latency;
+	long done;
+	long ok, no_path, budget, invalid;
+	int failed;
+} Client;
+
+static struct sockaddr_un addr;
+static char **lines = NULL; /* Linhas do .pal, com o '\n'. */
+static long num_lines = 0;
+static long requests = 1000; /* Problemas por cliente. */
+
+/**
+ * @brief Lê as linhas não vazias de um .pal.
+ *
+ * @param name Nome do ficheiro.
+ */
+static void read_lines(const char *name)
+{
+	FILE *f = efopen(name, "r");
+	char buffer[3 * MAX_WORD_SIZE];
+	long max = 0;
+
+	while (fgets(buffer, sizeof(buffer), f) != NULL) {
+		if (strspn(buffer, " \t\r\n") == strlen(buffer)) continue;
+		if (num_lines == max) {
+			max = max ? 2 * max : 1024;
+			lines = (char **) erealloc(lines, max * sizeof(char *));
+		}
+		if (strchr(buffer, '\n') == NULL) {
+			strcat(buffer, "\n");
+		}
+		lines[num_lines] = (char *) emalloc(strlen(buffer) + 1);
+		strcpy(lines[num_lines++], buffer);
+	}
+	fclose(f);
+}
+
+/**
+ * @brief Lê um bloco de resposta (até uma linha em branco) e classifica-o
+ *	pelo custo da primeira linha.
+ *
+ * @param in Ligação.
+ * @param c Cliente, cujos contadores são atualizados.
+ * @return 0 em caso de sucesso, -1 se a ligação fechou.
+ */
+static int read_block(FILE *in, Client *c)
+{
+	char line[3 * MAX_WORD_SIZE];
+	char word[MAX_WORD_SIZE];
+	int cost = NO_PATH;
+	bool first = true;
+
+	while (fgets(line, sizeof(line), in) != NULL) {
+		if (line[0] == '\n') {
+			if (cost >= 0) c->ok++;
+			else if (cost == NO_PATH) c->no_path++;
+			else if (cost == INVALID_PROBLEM) c->invalid++;
+			else c->budget++;
+			return 0;
+		}
+		if (first) {
+			sscanf(line, "%63s %d", word, &cost);
+			first = false;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * @brief Ciclo de um cliente: enviar problemas e esperar as respostas.
+ *
+ * @param arg Cliente (Client *).
+ * @return NULL.
+ */
+static void *client(void *arg)
+{
+	Client *c = (Client *) arg;
+	FILE *in, *out;
+	int fd;
+	long i;
+	double start;
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd == -1 || connect(fd, (struct sockaddr *) &addr, sizeof(addr)) == -1) {
+		perror(addr.sun_path);
+		c->failed = 1;
+		if (fd != -1) close(fd);
+		return NULL;
+	}
+	in = fdopen(fd, "r");
+	out = fdopen(dup(fd), "w");
+
+	for (i = 0; i < requests; i++) {
+		start = mono_time();
+		fputs(lines[(c->first + i) % num_lines], out);
+		fflush(out);
+		if (read_block(in, c) != 0) {
+			c->failed = 1;
+			break;
+		}
+		c->latency[c->done++] = mono_time() - start;
+	}
+
+	fclose(out);
+	fclose(in);
+	return NULL;
+}
+
+/**
+ * @brief Comparador de doubles para qsort().
+ */
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *((const double *) a), y = *((const double *) b);
+
+	return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv)
+{
+	Client *c;
+	int clients = 4;
+	double *all, start, wall;
+	long total = 0, ok = 0, no_path = 0, budget = 0, invalid = 0;
+	int i, failed = 0;
+	long j;
+
+	for (i = 1; i < argc && strncmp(argv[i], "--", 2) == 0; i++) {
+		if (strncmp(argv[i], "--clients=", 10) == 0) {
+			clients = atoi(argv[i] + 10);
+		}
+		else if (strncmp(argv[i], "--requests=", 11) == 0) {
+			requests = atol(argv[i] + 11);
+		}
+		else {
+			break;
+		}
+	}
+	if (argc - i != 2 || clients < 1 || clients > MAX_CLIENTS || requests < 1) {
+		fprintf(stderr, "Utilização: %s [--clients=N] [--requests=N] "
+			"socket problemas.pal\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	if (strlen(argv[i]) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "Erro: caminho da socket comprido de mais.\n");
+		return EXIT_FAILURE;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, argv[i]);
+
+	read_lines(argv[i+1]);
+	if (num_lines == 0) {
+		fprintf(stderr, "Erro: %s não tem problemas.\n", argv[i+1]);
+		return EXIT_FAILURE;
+	}
+
+	c = (Client *) ecalloc(clients, sizeof(Client));
+	start = mono_time();
+	for (i = 0; i < clients; i++) {
+		c[i].first = (long) ((double) i * num_lines / clients);
+		c[i].latency = (double *) emalloc(requests * sizeof(double));
+		if (pthread_create(&c[i].thread, NULL, client, &c[i]) != 0) {
+			fprintf(stderr, "Erro: impossível criar cliente.\n");
+			return EXIT_FAILURE;
+		}
+	}
+	for (i = 0; i < clients; i++) {
+		pthread_join(c[i].thread, NULL);
+	}
+	wall = mono_time() - start;
+
+	all = (double *) emalloc(clients * requests * sizeof(double));
+	for (i = 0; i < clients; i++) {
+		for (j = 0; j < c[i].done; j++) {
+			all[total++] = c[i].latency[j];
+		}
+		ok += c[i].ok;
+		no_path += c[i].no_path;
+		budget += c[i].budget;
+		invalid += c[i].invalid;
+		failed += c[i].failed;
+		free(c[i].latency);
+	}
+
+	printf("clientes %d, problemas %ld, %.3f s, %.1f problemas/s\n",
+		clients, total, wall, total / wall);
+	if (total > 0) {
+		qsort(all, total, sizeof(double), cmp_double);
+		printf("latência (ms): p50 %.3f  p90 %.3f  p99 %.3f  max %.3f\n",
+			all[total / 2] * 1e3, all[total * 9 / 10] * 1e3,
+			all[total * 99 / 100] * 1e3, all[total - 1] * 1e3);
+	}
+	printf("respostas: %ld com caminho, %ld sem caminho, %ld orçamento esgotado, "
+		"%ld inválidas\n", ok, no_path, budget, invalid);
+	if (failed > 0) {
+		printf("ligações falhadas: %d\n", failed);
+	}
+
+	for (j = 0; j < num_lines; j++) {
+		free(lines[j]);
+	}
+	free(lines);
+	free(all);
+	free(c);
+
+	return failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
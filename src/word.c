@@ -88,3 +88,21 @@ int w_cmp(Item v1, Item v2)
 {
 	return strcmp((const char *) v1, (const char *) v2);
 }
+
+/**
+ * @brief Função de dispersão de uma palavra (djb2).
+ *
+ * @param v Palavra.
+ * @return Valor de dispersão.
+ */
+unsigned long w_hash(Item v)
+{
+	unsigned long h = 5381;
+	unsigned char *w = (unsigned char *) v;
+
+	while (*w) {
+		h = h * 33 + *w++;
+	}
+
+	return h;
+}
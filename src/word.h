@@ -21,5 +21,6 @@ void w_free(Item word);
 
 unsigned short w_diff(Item v1, Item v2, unsigned short max_perm);
 int w_cmp(Item v1, Item v2);
+unsigned long w_hash(Item v);
 
 #endif
@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""Benchmark do wordmorph sobre os testes do vrfy.
+
+Corre cada teste*.pal (com portugues.dic) algumas vezes sem medir, para
+aquecer a cache de ficheiros, e depois N vezes a medir: tempo de parede,
+tempos de utilizador e de sistema (de wait4), e o RSS máximo e a divisão
+por fases dados por --stats. (O ru_maxrss de wait4 não serve: herda o RSS
+do python que fez fork.) O .path de cada execução é comparado com o .check.
+
+O resultado é um ficheiro JSON ordenado, para poder ser comparado com diff.
+Com --baseline, cada teste é comparado com o de uma execução anterior e o
+programa termina com código 1 se algum piorar mais do que --threshold.
+
+Utilização:
+    python3 bench.py [opções] [-- opções do wordmorph]
+"""
+import argparse
+import glob
+import json
+import os
+import statistics
+import sys
+import tempfile
+import time
+
+
+def check_path(path_file, check_file):
+    """Compara a primeira linha de cada bloco do .path com o .check."""
+    def headers(name):
+        with open(name) as f:
+            blocks = f.read().split('\n\n')
+        return [b.strip().split('\n')[0] for b in blocks if b.strip()]
+
+    return headers(path_file) == headers(check_file)
+
+
+def run(wordmorph, args, dic, pal, stats_file):
+    """Corre o wordmorph uma vez e devolve as medidas da execução."""
+    argv = [wordmorph] + args + ['--stats=' + stats_file, dic, pal]
+    start = time.monotonic()
+    pid = os.fork()
+    if pid == 0:
+        devnull = os.open(os.devnull, os.O_WRONLY)
+        os.dup2(devnull, 1)
+        os.dup2(devnull, 2)
+        try:
+            os.execv(wordmorph, argv)
+        finally:
+            os._exit(127)
+    _, status, usage = os.wait4(pid, 0)
+    wall = time.monotonic() - start
+
+    # Uma execução falhada pode deixar o relatório vazio ou de outra execução.
+    stats = {'phases': [], 'peak_rss_kb': 0}
+    if status == 0:
+        with open(stats_file) as f:
+            stats = json.load(f)
+    phases = {}
+    for p in stats['phases']:
+        phases[p['name']] = phases.get(p['name'], 0) + p['seconds']
+
+    return {
+        'status': os.waitstatus_to_exitcode(status),
+        'wall': wall,
+        'user': usage.ru_utime,
+        'system': usage.ru_stime,
+        'max_rss_kb': stats['peak_rss_kb'],
+        'phases': phases,
+    }
+
+
+def summarize(runs):
+    """Resume as execuções de um teste: mediana, mínimo e máximo."""
+    def spread(values):
+        return {
+            'median': round(statistics.median(values), 4),
+            'min': round(min(values), 4),
+            'max': round(max(values), 4),
+        }
+
+    names = sorted(set(n for r in runs for n in r['phases']))
+    return {
+        'wall': spread([r['wall'] for r in runs]),
+        'user': spread([r['user'] for r in runs]),
+        'system': spread([r['system'] for r in runs]),
+        'max_rss_kb': max(r['max_rss_kb'] for r in runs),
+        'phases': {n: round(statistics.median(r['phases'].get(n, 0) for r in runs), 4)
+                   for n in names},
+    }
+
+
+def compare(result, baseline, threshold):
+    """Lista as regressões de result em relação a baseline."""
+    regressions = []
+    for name, test in sorted(result['tests'].items()):
+        old = baseline['tests'].get(name)
+        if old is None:
+            continue
+        pairs = [
+            ('wall', test['wall']['median'], old['wall']['median']),
+            ('user', test['user']['median'], old['user']['median']),
+            ('max_rss_kb', test['max_rss_kb'], old['max_rss_kb']),
+        ]
+        for measure, new, ref in pairs:
+            if ref > 0 and (new - ref) / ref * 100 > threshold:
+                regressions.append('%s %s: %.4g -> %.4g (%+.1f%%)'
+                                   % (name, measure, ref, new, (new - ref) / ref * 100))
+    return regressions
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--wordmorph', default=os.path.join(here, '..', 'src', 'wordmorph'))
+    parser.add_argument('--dic', default=os.path.join(here, 'portugues.dic'))
+    parser.add_argument('--tests', default=os.path.join(here, 'teste*.pal'),
+                        help='padrão dos ficheiros .pal a correr')
+    parser.add_argument('--runs', type=int, default=3, help='execuções medidas por teste')
+    parser.add_argument('--warmup', type=int, default=1, help='execuções não medidas por teste')
+    parser.add_argument('--output', default='bench.json', help='ficheiro de resultados')
+    parser.add_argument('--baseline', help='resultados anteriores a comparar')
+    parser.add_argument('--threshold', type=float, default=10.0,
+                        help='piora máxima tolerada, em percentagem')
+    parser.add_argument('args', nargs='*', help='opções do wordmorph (depois de --)')
+    opts = parser.parse_args()
+
+    wordmorph = os.path.abspath(opts.wordmorph)
+    result = {'args': opts.args, 'runs': opts.runs, 'warmup': opts.warmup, 'tests': {}}
+    failed = False
+    fd, stats_file = tempfile.mkstemp(suffix='.json')
+    os.close(fd)
+
+    try:
+        for pal in sorted(glob.glob(opts.tests)):
+            name = os.path.splitext(os.path.basename(pal))[0]
+            check = os.path.splitext(pal)[0] + '.check'
+            runs = []
+            ok = True
+            for i in range(opts.warmup + opts.runs):
+                r = run(wordmorph, opts.args, opts.dic, pal, stats_file)
+                if r['status'] != 0:
+                    ok = False
+                elif os.path.exists(check):
+                    ok = ok and check_path(os.path.splitext(pal)[0] + '.path', check)
+                if i >= opts.warmup:
+                    runs.append(r)
+
+            test = summarize(runs)
+            test['ok'] = ok
+            result['tests'][name] = test
+            failed = failed or not ok
+            print('%-10s %-4s wall %8.3fs  user %8.3fs  rss %8d KB'
+                  % (name, 'OK' if ok else 'FAIL', test['wall']['median'],
+                     test['user']['median'], test['max_rss_kb']), flush=True)
+    finally:
+        os.remove(stats_file)
+
+    with open(opts.output, 'w') as f:
+        json.dump(result, f, indent=2, sort_keys=True)
+        f.write('\n')
+
+    if opts.baseline:
+        with open(opts.baseline) as f:
+            baseline = json.load(f)
+        regressions = compare(result, baseline, opts.threshold)
+        for r in regressions:
+            print('regressão: ' + r)
+        failed = failed or bool(regressions)
+
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())